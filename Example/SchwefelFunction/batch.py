@@ -0,0 +1,41 @@
+import csv
+import json
+import struct
+import numpy as np
+
+# reader for the results tables written by GA_run --batch (lib/batch.hpp), csv or binary
+
+MAGIC = b"GATABLE\0"
+HEADER = struct.Struct("<8sIIQ")  # magic, version, columns, rows
+
+def readBinary(path):
+    # returns {column name: numpy array}
+    with open(path, "rb") as f:
+        buffer = f.read()
+    magic, version, columns, rows = HEADER.unpack_from(buffer, 0)
+    if magic != MAGIC or version != 1:
+        raise ValueError(path + " is not a version 1 batch table")
+    offset = HEADER.size
+    names = []
+    for c in range(columns):
+        (length,) = struct.unpack_from("<I", buffer, offset)
+        names.append(buffer[offset+4:offset+4+length].decode())
+        offset += 4 + length
+    data = np.frombuffer(buffer, dtype="<f8", count=rows*columns, offset=offset).reshape(rows, columns)
+    return {name: data[:, c] for c, name in enumerate(names)}
+
+def readCsv(path):
+    # the same for a csv table, grid values keep their json type (strings, booleans)
+    with open(path, newline="") as f:
+        rows = list(csv.reader(f))
+    names, rows = rows[0], rows[1:]
+    table = {}
+    for c, name in enumerate(names):
+        values = [json.loads(row[c]) for row in rows]
+        table[name] = np.array(values, dtype=object if any(isinstance(v, (str, bool)) for v in values) else float)
+    return table
+
+def loadTable(path):
+    if path.endswith(".csv"):
+        return readCsv(path)
+    return readBinary(path)
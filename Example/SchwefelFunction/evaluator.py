@@ -0,0 +1,38 @@
+import math
+import struct
+import sys
+import time
+
+# an out-of-process evaluator of Schwefel's function for "steady state" runs (lib/evaluator.hpp):
+#   "steady state": true, "reproducible": false, "evaluator": "python3 evaluator.py [seconds]"
+# the GA sends the dimension once, then each candidate's coordinates, and reads back its objective,
+# all native endian. The optional seconds stand in for a slow simulation, each evaluation sleeps
+# that long
+
+def readExactly(stream, size):
+    # None once the GA closed the connection
+    data = stream.read(size)
+    return data if len(data) == size else None
+
+def schwefel(x, lower=-500, upper=500):
+    # the same objective as Example/SchwefelFunction/problem.hpp, infeasible outside the bounds
+    if any(xi < lower or xi > upper for xi in x):
+        return 3.4028234663852886e38
+    return -sum(xi * math.sin(math.sqrt(abs(xi))) for xi in x)
+
+if __name__ == "__main__":
+    delay = float(sys.argv[1]) if len(sys.argv) > 1 else 0
+    stdin, stdout = sys.stdin.buffer, sys.stdout.buffer
+    header = readExactly(stdin, 4)
+    if header is None:
+        sys.exit(0)
+    (dimension,) = struct.unpack("=i", header)
+    candidate = struct.Struct("=%df" % dimension)
+    while True:
+        data = readExactly(stdin, candidate.size)
+        if data is None:
+            break
+        if delay > 0:
+            time.sleep(delay)
+        stdout.write(struct.pack("=f", schwefel(candidate.unpack(data))))
+        stdout.flush()
@@ -4,6 +4,18 @@
 #include "../../lib/solution.hpp"
 #include "../../lib/core.hpp"
 #include "../../lib/utils.hpp"
+#include "../../lib/simd.hpp"
+#include "../../lib/population.hpp"
+#include "../../lib/coordinates.hpp"
+#include "../../lib/config.hpp"
+#include "../../lib/ranking.hpp"
+#include "../../lib/selection.hpp"
+#include "../../lib/operators.hpp"
+#include "../../lib/threadpool.hpp"
+#include "../../lib/budget.hpp"
+#include "../../lib/random.hpp"
+#include "../../lib/cache.hpp"
+#include "../../lib/profile.hpp"
 #include <cstdlib>
 #include <ostream>
 #include <cmath>
@@ -14,176 +26,584 @@
 #include <utility>
 #include <limits>
 
-#define DIMENSION 6 // to change this define for number of dimensions considered
-
 namespace Schwefel
 {
-    static int num_of_evaluations = 0; // track the total number of evaluations of Schwefel's function
+class Context
+{   // what the GA lends the problem while a stage runs: the stream to draw from (see lib/random.hpp),
+    // the share of the evaluation budget to charge (see lib/budget.hpp), the fitness cache, if any
+    // (see lib/cache.hpp), and the mutation scale of a boosted island (see lib/convergence.hpp). Every
+    // Problem holds its own, so GA instances running side by side (see
+    // lib/batch.hpp) never touch each other's
+private:
+    Philox _fallback; // a fixed default stream, for calls made outside the GA
 
-    static thread_local std::mt19937 randomGen; // a copy is created for each thread, so that we don't share
-                                                // the random generator which slows thread execution
+public:
+    Philox* randomGen = nullptr;
+    EvaluationQuota* evaluationQuota = nullptr;
+    FitnessCache* fitnessCache = nullptr;
+    std::vector<char> missed; // scratch of evaluateCached, kept across generations
+    float mutationScale = 1;  // of the crossover's spread, "Breeding Variance Scale" or "blend alpha"
 
-class soln : public solution
+    Philox& generator() { return randomGen ? *randomGen : _fallback; }
+
+    long acquireEvaluations(long n)
+    {   // how many of n evaluations may be made
+        return evaluationQuota ? evaluationQuota->acquire(n) : n;
+    }
+};
+
+Context& threadContext()
+{   // the context of the ProblemCtx function-pointer path, whose functions have no instance to keep it in
+    static thread_local Context context;
+    return context;
+}
+
+struct Config
+{   // parameters of Schwefel's problem, see lib/config.hpp
+    int dimension;                // "dimension"
+    float minXi;                  // "min xi", lower bound of every coordinate
+    float maxXi;                  // "max xi", upper bound of every coordinate
+    float selectionPressure;      // "selection pressure", S in the ranking selection, 1 <= S <= 2
+    float breedingVarianceScale;  // "Breeding Variance Scale", of the "normal" crossover
+    SelectionMethod selectionMethod = SelectionMethod::ranking; // "selection method" (default "ranking"), see lib/selection.hpp
+    int parentsPerGeneration = 2; // "parents per generation" (default 2), ignored by "ranking"
+    int tournamentSize = 2;       // "tournament size" (default 2)
+    Crossover crossover = Crossover::normal; // "crossover" (default "normal"): "normal" or "blend", see lib/operators.hpp
+    BoundaryHandling boundaryHandling = BoundaryHandling::truncate; // "boundary handling" (default "truncate"):
+                                  // "truncate", "reflect" or "clamp"
+    float blendAlpha = 0.5f;      // "blend alpha" (default 0.5), how far past its parents a "blend" child reaches
+
+    static Config read(ConfigReader& reader)
+    {
+        Config c;
+        c.dimension = reader.get<int>("dimension");
+        c.minXi = reader.get<float>("min xi");
+        c.maxXi = reader.get<float>("max xi");
+        c.selectionPressure = reader.get<float>("selection pressure");
+        c.breedingVarianceScale = reader.get<float>("Breeding Variance Scale");
+        c.selectionMethod = parseSelectionMethod(reader.get<std::string>("selection method", "ranking"));
+        c.parentsPerGeneration = reader.get<int>("parents per generation", 2);
+        c.tournamentSize = reader.get<int>("tournament size", 2);
+        c.crossover = parseCrossover(reader.get<std::string>("crossover", "normal"));
+        c.boundaryHandling = parseBoundaryHandling(reader.get<std::string>("boundary handling", "truncate"));
+        c.blendAlpha = reader.get<float>("blend alpha", 0.5f);
+
+        require(c.dimension >= 1, "\"dimension\" must be at least 1");
+        require(c.minXi < c.maxXi, "\"min xi\" must be less than \"max xi\"");
+        require(c.selectionPressure >= 1 && c.selectionPressure <= 2, "\"selection pressure\" must be within [1, 2]");
+        require(c.breedingVarianceScale > 0, "\"Breeding Variance Scale\" must be positive");
+        require(c.parentsPerGeneration >= 2, "\"parents per generation\" must be at least 2");
+        require(c.tournamentSize >= 1, "\"tournament size\" must be at least 1");
+        require(c.blendAlpha >= 0, "\"blend alpha\" must not be negative");
+        return c;
+    }
+};
+
+// the dimensions compiled as fixed-size specialisations, any other dimension runs on soln<0>
+#define SCHWEFEL_DIMENSIONS 2, 3, 5, 6, 10, 20, 30, 50, 100
+
+// strided view of a batch of solutions for the vectorised evaluation kernels:
+// coordinate d of solution j is x[j*solnStride + d*dimStride], or rows[j][d] when rows is set
+// (solutions whose coordinates live in separate pooled blocks), its objective goes to f[j*fStride]
+struct BatchView
 {
+    const float* x;
+    int solnStride;
+    int dimStride;
+    float* f;
+    int fStride;
+    int n;
+    int dimension;
+    const float* const* rows = nullptr;
+};
+
+template <int D>
+void evaluateBatchScalar(const BatchView& b, int begin, float lbound, float ubound)
+{   // reference kernel, also used for the tail of the vectorised kernels
+    const int dimension = D > 0 ? D : b.dimension;
+    for(int j=begin; j<b.n; j++)
+    {
+        float tmp = 0;
+        for(int i=0; i<dimension; i++)
+        {
+            float xi = b.rows ? b.rows[j][i] : b.x[j*b.solnStride + i*b.dimStride];
+            if(xi < lbound || xi > ubound)
+            {
+                tmp = std::numeric_limits<float>::max(); // solution is outside constraints
+                break;
+            }
+            tmp -= xi * std::sin(std::sqrt(std::fabs(xi)));
+        }
+        b.f[j*b.fStride] = tmp;
+    }
+}
+
+#if GA_SIMD_X86
+template <int D>
+GA_TARGET_AVX2 void evaluateBatchAVX2(const BatchView& b, float lbound, float ubound)
+{   // 8 solutions per step, gathering coordinates when solutions are not contiguous
+    const int dimension = D > 0 ? D : b.dimension;
+    const __m256 lb = _mm256_set1_ps(lbound);
+    const __m256 ub = _mm256_set1_ps(ubound);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                               _mm256_set1_epi32(b.solnStride));
+    int j = 0;
+    for(; j+8<=b.n; j+=8)
+    {
+        __m256i rowLo = _mm256_setzero_si256(); // byte offsets of rows j+1..j+7 from row j
+        __m256i rowHi = _mm256_setzero_si256();
+        if(b.rows)
+        {
+            __m256i first = _mm256_set1_epi64x(reinterpret_cast<intptr_t>(b.rows[j]));
+            rowLo = _mm256_sub_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.rows + j)), first);
+            rowHi = _mm256_sub_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.rows + j + 4)), first);
+        }
+        __m256 acc = _mm256_setzero_ps();
+        __m256 outside = _mm256_setzero_ps();
+        for(int i=0; i<dimension; i++)
+        {
+            __m256 xi;
+            if(b.rows)
+            {
+                const float* base = b.rows[j] + i;
+                xi = _mm256_set_m128(_mm256_i64gather_ps(base, rowHi, 1), _mm256_i64gather_ps(base, rowLo, 1));
+            }else
+            {
+                const float* base = b.x + j*b.solnStride + i*b.dimStride;
+                xi = (b.solnStride == 1) ? _mm256_loadu_ps(base) : _mm256_i32gather_ps(base, offsets, 4);
+            }
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(xi, lb, _CMP_LT_OQ));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(xi, ub, _CMP_GT_OQ));
+            __m256 s = simd::sin256(_mm256_sqrt_ps(_mm256_and_ps(xi, absMask)));
+            acc = _mm256_fnmadd_ps(xi, s, acc);
+        }
+        acc = _mm256_blendv_ps(acc, _mm256_set1_ps(std::numeric_limits<float>::max()), outside);
+        if(b.fStride == 1)
+        {
+            _mm256_storeu_ps(b.f + j, acc);
+        }else
+        {
+            alignas(32) float tmp[8];
+            _mm256_store_ps(tmp, acc);
+            for(int k=0; k<8; k++) b.f[(j+k)*b.fStride] = tmp[k];
+        }
+    }
+    evaluateBatchScalar<D>(b, j, lbound, ubound);
+}
+
+template <int D>
+GA_TARGET_AVX512 void evaluateBatchAVX512(const BatchView& b, float lbound, float ubound)
+{   // 16 solutions per step, using native scatter when the objectives are not contiguous
+    const int dimension = D > 0 ? D : b.dimension;
+    const __m512 lb = _mm512_set1_ps(lbound);
+    const __m512 ub = _mm512_set1_ps(ubound);
+    const __m512i lane = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m512i offsets = _mm512_mullo_epi32(lane, _mm512_set1_epi32(b.solnStride));
+    const __m512i fOffsets = _mm512_mullo_epi32(lane, _mm512_set1_epi32(b.fStride));
+    int j = 0;
+    for(; j+16<=b.n; j+=16)
+    {
+        __m512i rowLo = _mm512_setzero_si512(); // byte offsets of rows j+1..j+15 from row j
+        __m512i rowHi = _mm512_setzero_si512();
+        if(b.rows)
+        {
+            __m512i first = _mm512_set1_epi64(reinterpret_cast<intptr_t>(b.rows[j]));
+            rowLo = _mm512_sub_epi64(_mm512_loadu_si512(b.rows + j), first);
+            rowHi = _mm512_sub_epi64(_mm512_loadu_si512(b.rows + j + 8), first);
+        }
+        __m512 acc = _mm512_setzero_ps();
+        __mmask16 outside = 0;
+        for(int i=0; i<dimension; i++)
+        {
+            __m512 xi;
+            if(b.rows)
+            {
+                const float* base = b.rows[j] + i;
+                __m512d lo = _mm512_castps_pd(_mm512_castps256_ps512(_mm512_i64gather_ps(rowLo, base, 1)));
+                __m256d hi = _mm256_castps_pd(_mm512_i64gather_ps(rowHi, base, 1));
+                xi = _mm512_castpd_ps(_mm512_insertf64x4(lo, hi, 1));
+            }else
+            {
+                const float* base = b.x + j*b.solnStride + i*b.dimStride;
+                xi = (b.solnStride == 1) ? _mm512_loadu_ps(base) : _mm512_i32gather_ps(offsets, base, 4);
+            }
+            outside |= _mm512_cmp_ps_mask(xi, lb, _CMP_LT_OQ) | _mm512_cmp_ps_mask(xi, ub, _CMP_GT_OQ);
+            __m512 s = simd::sin512(_mm512_sqrt_ps(_mm512_abs_ps(xi)));
+            acc = _mm512_fnmadd_ps(xi, s, acc);
+        }
+        acc = _mm512_mask_blend_ps(outside, acc, _mm512_set1_ps(std::numeric_limits<float>::max()));
+        if(b.fStride == 1) _mm512_storeu_ps(b.f + j, acc);
+        else _mm512_i32scatter_ps(b.f + j*b.fStride, fOffsets, acc, 4);
+    }
+    evaluateBatchScalar<D>(b, j, lbound, ubound);
+}
+#endif // GA_SIMD_X86
+
+template <int D>
+void evaluateBatch(const BatchView& b, float lbound, float ubound)
+{   // evaluate Schwefel's function on a whole batch using the widest kernel the cpu supports
+#if GA_SIMD_X86
+    switch(simd::activeIsa())
+    {
+        case simd::Isa::avx512: evaluateBatchAVX512<D>(b, lbound, ubound); return;
+        case simd::Isa::avx2: evaluateBatchAVX2<D>(b, lbound, ubound); return;
+        default: break;
+    }
+#endif
+    evaluateBatchScalar<D>(b, 0, lbound, ubound);
+}
+
+template <int D>
+class soln : public solution
+{   // D is the dimension of the problem, D = 0 takes the dimension at runtime (see coordinates.hpp)
 private:
-    float x[DIMENSION]; // using array instead of vector to have it stored on stack for faster creation/access/deletion
+    Coordinates<D> x; // for D > 0 an array instead of vector to have it stored on stack for faster creation/access/deletion
     float f;
     float _lbound;
     float _ubound;
 
     float evaluateObjective()
     {   // evaluate Schwefel's function on this solution
-        num_of_evaluations += 1;
         float tmp = 0;
-        for(int i=0; i<DIMENSION; i++) 
+        for(int i=0; i<dimension(); i++) 
         {
-            if(x[i] < _lbound | x[i] > _ubound) return std::numeric_limits<float>::max(); // solution is outside constraints
+            if(x[i] < _lbound || x[i] > _ubound) return std::numeric_limits<float>::max(); // solution is outside constraints
             tmp -= x[i] * std::sin(std::sqrt(std::fabs(x[i])));
         }
         return tmp;
     }
 
 public:
-    soln(float lowerbound, float upperbound)
+    soln(int dimension, float lowerbound, float upperbound, Philox& generator, bool evaluate = true) : x(dimension)
     {  // randomly generate a soln within the provided constraints
+       // (pass evaluate=false when the soln will be scored later as part of a batch)
         _lbound = lowerbound;
         _ubound = upperbound;
         std::uniform_real_distribution<float> urand{lowerbound, upperbound};
-        for(int i=0; i<DIMENSION; i++) x[i] = urand(Schwefel::randomGen);
-        f = evaluateObjective();
+        for(int i=0; i<this->dimension(); i++) x[i] = urand(generator);
+        f = evaluate ? evaluateObjective() : 0;
     }
 
-    soln()
+    explicit soln(int dimension = D) : x(dimension)
     {   // default constructor
         _lbound = 0;
         _ubound = 0;
-        for(int i=0; i<DIMENSION; i++) x[i] = 0;
+        for(int i=0; i<this->dimension(); i++) x[i] = 0;
         f = 0;
     }
 
+    int dimension() const { return x.size(); }
+
     void doEval(){ f = evaluateObjective(); }
 
-    float getEval(){ return f; }
+    float getEval() const { return f; }
 
-    float getX(int i){ return x[i]; }
+    void setEval(float val){ f = val; }
+
+    float getX(int i) const { return x[i]; }
 
     void setX(int i, float val){ x[i]=val; }
 
+    float getLowerBound() const { return _lbound; }
+
+    float getUpperBound() const { return _ubound; }
+
+    void setBounds(float lowerbound, float upperbound){ _lbound = lowerbound; _ubound = upperbound; }
+
     friend std::ostream& operator<< (std::ostream& stream, const soln& s)
     {   // for printing out the contents of a solution
-        for(int i=0; i<DIMENSION; i++) stream << s.x[i] << ", ";
+        for(int i=0; i<s.dimension(); i++) stream << s.x[i] << ", ";
         stream << s.f;
         return stream;
     }
 
+    template <int Dim>
+    friend void evaluateBatch(std::vector<soln<Dim>>& population, int rangeStart, int rangeEnd);
+
     std::string print()
     {   // same goal as operator<<, but slightly more formatted
         std::stringstream ss;
         ss << "x: [";
-        for(int i=0; i<DIMENSION-1; i++) ss << x[i] << ", ";
-        ss << x[DIMENSION-1] << "] f: " << f;
+        for(int i=0; i<dimension()-1; i++) ss << x[i] << ", ";
+        ss << x[dimension()-1] << "] f: " << f;
         return ss.str();
     }
 };
 
-float l2(soln& s1, soln& s2)
-{  // get the l2 norm of s1-s2
-    float sum = 0; 
-    for(int i=0; i<DIMENSION; i++) sum += std::pow(s1.getX(i) - s2.getX(i), 2);
-    return std::pow(sum, 0.5);
+template <int D>
+using SoA = SoAPopulation<soln<D>>; // structure-of-arrays layout of a population of soln
+
+template <int D>
+void evaluateBatch(std::vector<soln<D>>& population, int rangeStart, int rangeEnd)
+{   // score population[rangeStart:rangeEnd] in one call, all solutions in a batch share the
+    // constraints of its first member (true for every soln created by this problem)
+    if(rangeEnd <= rangeStart) return;
+    static_assert(sizeof(soln<D>) % sizeof(float) == 0, "soln must be a whole number of floats for strided access");
+    soln<D>& first = population[rangeStart];
+    if constexpr(D > 0)
+    {
+        constexpr int stride = sizeof(soln<D>) / sizeof(float);
+        BatchView b{first.x.data(), stride, 1, &first.f, stride, rangeEnd - rangeStart, D};
+        evaluateBatch<D>(b, first._lbound, first._ubound);
+    }else
+    {   // pooled coordinates are not at a fixed stride, so the kernels gather them through row pointers,
+        // collected in fixed blocks on the stack
+        constexpr int blockSize = 256;
+        constexpr int stride = sizeof(soln<0>) / sizeof(float);
+        const float* rows[blockSize];
+        for(int begin=rangeStart; begin<rangeEnd; begin+=blockSize)
+        {
+            const int n = std::min(blockSize, rangeEnd - begin);
+            for(int j=0; j<n; j++) rows[j] = population[begin+j].x.data();
+            BatchView b{nullptr, 0, 0, &population[begin].f, stride, n, first.dimension(), rows};
+            evaluateBatch<0>(b, first._lbound, first._ubound);
+        }
+    }
+}
+
+template <int D>
+void evaluateBatch(SoA<D>& population, int rangeStart, int rangeEnd)
+{   // columns are contiguous, so the kernels use plain vector loads instead of gathers
+    if(rangeEnd <= rangeStart) return;
+    BatchView b{population.column(0) + rangeStart, 1, population.capacity(),
+                population.fitness() + rangeStart, 1, rangeEnd - rangeStart, population.dimension()};
+    evaluateBatch<D>(b, population.getLowerBound(), population.getUpperBound());
+}
+
+template <typename Population>
+void evaluateParallel(Population& population, int rangeStart, int rangeEnd)
+{   // batches larger than one grain are split into tasks on the shared pool, smaller ones are scored in place
+    profile::Scope phase(profile::Phase::evaluation);
+    constexpr int grain = 4096;
+    if(rangeEnd - rangeStart <= grain) return evaluateBatch(population, rangeStart, rangeEnd);
+    ThreadPool::shared().parallelFor(rangeStart, rangeEnd, grain, 
+                                     [&](int begin, int end){ evaluateBatch(population, begin, end); });
+}
+
+template <int D>
+std::vector<soln<D>> makePopulation(std::vector<soln<D>>*, int size, int dimension, float lowerbound, float upperbound)
+{   // size zeroed, unevaluated solutions within the provided constraints
+    soln<D> s(dimension);
+    s.setBounds(lowerbound, upperbound);
+    return std::vector<soln<D>>(size, s);
+}
+
+template <int D>
+SoA<D> makePopulation(SoA<D>*, int size, int dimension, float lowerbound, float upperbound)
+{
+    return SoA<D>(dimension, lowerbound, upperbound, size);
+}
+
+template <typename Population>
+Population makePopulation(int size, int dimension, float lowerbound, float upperbound)
+{   // the pointer argument only selects the overload for the requested layout
+    return makePopulation(static_cast<Population*>(nullptr), size, dimension, lowerbound, upperbound);
+}
+
+template <int D>
+void resizePopulation(std::vector<soln<D>>& population, int size, int capacity, int dimension, 
+                      float lowerbound, float upperbound)
+{   // reuse population's storage for size unevaluated solutions, reserving capacity up front so
+    // later generations never reallocate
+    if(population.capacity() < std::max(size, capacity)) population.reserve(std::max(size, capacity));
+    if(population.size() < size)
+    {
+        soln<D> s(dimension);
+        s.setBounds(lowerbound, upperbound);
+        population.resize(size, s);
+    }else population.erase(population.begin() + size, population.end());
+}
+
+template <int D>
+void resizePopulation(SoA<D>& population, int size, int capacity, int dimension, float lowerbound, float upperbound)
+{
+    if(population.dimension() != dimension) population = SoA<D>(dimension, lowerbound, upperbound);
+    if(population.capacity() < std::max(size, capacity)) population.reserve(std::max(size, capacity));
+    population.resize(size);
 }
 
-// set the random gen for this thread
-void setThreadRandomGenerator(std::mt19937 gen){randomGen = gen;} 
+// set the random stream of this thread's context (nullptr: the default stream)
+void setThreadRandomGenerator(Philox* gen){threadContext().randomGen = gen;}
 
-soln getBestSoln(std::vector<soln>& population)
+// set the evaluation quota charged by this thread's context (nullptr: evaluations are not counted)
+void setThreadEvaluationQuota(EvaluationQuota* quota){threadContext().evaluationQuota = quota;}
+
+template <typename Population>
+auto getBestSoln(Population& population)
 {   // return the best soln in the population
     int idx_best = 0;
     for(int i=0; i<population.size(); i++)
     {
         if(population[i].getEval() < population[idx_best].getEval()) idx_best = i;
     }
-    return population[idx_best];
+    return static_cast<typename Population::value_type>(population[idx_best]);
+}
+
+template <typename Population>
+void getRandomSolutions(int size, Population& v, const Config& config, Context& context)
+{   // size random solutions into v's storage, evaluated as one batch. Nothing is charged, the
+    // caller acquires the evaluations
+    const int dimension = config.dimension;
+    resizePopulation(v, size, size, dimension, config.minXi, config.maxXi);
+    constexpr int chunk = 64; // coordinates drawn in bulk at a time
+    float x[chunk];
+    int next = chunk;
+    for(int i=0; i<size; i++)
+    {
+        for(int ii=0; ii<dimension; ii++)
+        {
+            if(next == chunk)
+            {
+                context.generator().fillUniform(x, chunk, config.minXi, config.maxXi);
+                next = 0;
+            }
+            v[i].setX(ii, x[next++]);
+        }
+    }
+    evaluateParallel(v, 0, v.size());
 }
 
-std::vector<soln> getInitialPopulation(int size, std::unordered_map<std::string, float>& parameters)
+template <typename Population>
+Population getInitialPopulation(int size, const Config& config, Context& context)
 {   // randomly initialise initial population
-    std::vector<soln> v;
-    for(int i=0; i<size; i++) v.push_back(soln(
-        parameters["min xi"],
-        parameters["max xi"]
-    ));
+    context.acquireEvaluations(size); // "max_eval" always covers the initial population
+    Population v = makePopulation<Population>(size, config.dimension, config.minXi, config.maxXi);
+    getRandomSolutions(size, v, config, context);
     return v;
 }
 
-std::pair<std::vector<int>, 
-          std::vector<std::pair<float, int>>> getParentIdx(std::vector<soln>& population, int rangeStart, int rangeEnd, 
-                              std::unordered_map<std::string, float>& parameters)
-{  /* parents chosen by ranking selection
+template <typename Population>
+Population getInitialPopulation(int size, const Config& config)
+{   // on this thread's context, for the ProblemCtx path
+    return getInitialPopulation<Population>(size, config, threadContext());
+}
+
+template <typename Population>
+void getParentIdx(Population& population, int rangeStart, int rangeEnd, 
+                  std::vector<int>& chosenParents, Ranking& ranking, RankSelector& selector,
+                  const Config& config, Context& context)
+{  /* parents chosen by the configured selection method on the ranks of population[rangeStart:rangeEnd],
+      by default ranking selection
       p(selected)=(S*(N+1-2*R_i) + 2*(R_i-1))/(N*(N-1)) 
       where S = selection pressure, N is size of population considered,
       R_i is the solution rank */ 
     
-    // get the rank of each solution
-    float N = rangeEnd - rangeStart;
-    std::vector<std::pair<float, int>> sortingArr;
-    for(int i=rangeStart; i<rangeEnd; i++) sortingArr.push_back(std::pair<float, int>(population[i].getEval(), i));
-    struct {
-        bool operator()(std::pair<float, int> s1, std::pair<float, int> s2) const {return s1.first < s2.first;}
-    } compareFunc;
-    std::sort(sortingArr.begin(), sortingArr.end(), compareFunc);
-
-    // probabilistically choose parents
-    std::vector<int> chosenParents;
-    for(int i=0; i<sortingArr.size(); i++)
-    {
-        float rank = i+1;
-        float acceptCriteria = 
-            (parameters["selection pressure"] * (N + 1 - 2 * rank) + 2 * (rank-1)) /
-            (N * (N-1));
-        if(intRand(0, RAND_MAX, randomGen) < RAND_MAX * acceptCriteria) chosenParents.push_back(sortingArr[i].second);
-    }
-
-    return std::pair<std::vector<int>, std::vector<std::pair<float, int>>>{chosenParents, sortingArr};
-}
-
-std::vector<soln> getChildren(std::vector<soln>& population, std::vector<int>& parentIdx, 
-                              std::unordered_map<std::string, float>& parameters)
-{   // each parent will randomly pair with another parent and undergo crossover
-    // to produce children, ie. draw X~N(parent1, (Breeding_Variance_Scale)*||parent1-parent2||_2))
-    std::vector<soln> children;
-    if(parentIdx.size() < 2) return children; // no children produced
-
-    for(int i=0; i<parentIdx.size(); i++)
-    {
-        // randomly choose the other parent from the parent candidates
-        int otherParentIdx = i;
-        while(otherParentIdx == i) otherParentIdx = intRand(0, parentIdx.size(), randomGen);
-
-        // sample from Normal Dist for new children soln
-        std::normal_distribution<float> rn{0, parameters["Breeding Variance Scale"] * l2(population[i], population[otherParentIdx])};
-        soln child(parameters["min xi"], parameters["max xi"]);
-        Schwefel::num_of_evaluations -= 1; // there was an extra evaluation done when initialising soln
-        for(int ii=0; ii<DIMENSION; ii++)
+    // the ranking is kept up to date by updatePopulation, it is only sorted from scratch when stale
+    const int n = rangeEnd - rangeStart;
+    if(ranking.size() != n) ranking.rebuild(population, rangeStart, rangeEnd);
+
+    // draw the ranks of the parents, then look up which solutions hold them
+    selector.prepare(n, config.selectionPressure);
+    selector.sample(std::min(config.parentsPerGeneration, n), context.generator(), chosenParents);
+    for(int i=0; i<chosenParents.size(); i++) chosenParents[i] = ranking[chosenParents[i]].second;
+}
+
+template <typename Population>
+std::pair<std::vector<int>, 
+          std::vector<std::pair<float, int>>> getParentIdx(Population& population, int rangeStart, int rangeEnd, 
+                              const Config& config)
+{   // allocating form, for the ProblemCtx path (ranks and builds the selection tables every call)
+    std::pair<std::vector<int>, std::vector<std::pair<float, int>>> result;
+    Ranking ranking;
+    RankSelector selector(config.selectionMethod, config.tournamentSize);
+    getParentIdx(population, rangeStart, rangeEnd, result.first, ranking, selector, config, threadContext());
+    result.second = ranking.sorted();
+    return result;
+}
+
+template <typename Population>
+void evaluateCached(Population& children, FitnessCache& cache, const Config& config, Context& context)
+{   // hits take the cached fitness, the misses the budget grants are evaluated (in runs of consecutive
+    // misses) and cached, the others dropped. Children keep their order
+    std::vector<char>& missed = context.missed;
+    missed.resize(children.size());
+    int misses = 0;
+    for(int i=0; i<children.size(); i++)
+    {
+        float fitness = 0;
+        missed[i] = !cache.lookup(children[i], fitness);
+        if(missed[i]) misses += 1;
+        else children[i].setEval(fitness);
+    }
+    long granted = context.acquireEvaluations(misses);
+    int kept = 0;
+    for(int i=0; i<children.size(); i++)
+    {
+        if(missed[i] && granted-- <= 0) continue;
+        if(kept != i)
         {
-            // repeat until drawn xi does not violate problem constraints
-            float newx = parameters["max xi"] + 1;
-            while((newx > parameters["max xi"]) | (newx < parameters["min xi"]))
-            {
-                newx = population[i].getX(ii) + rn(randomGen);
-            }
-            child.setX(ii, newx);
+            children[kept] = children[i];
+            missed[kept] = missed[i];
         }
-        child.doEval();
-        children.push_back(child);
+        kept += 1;
     }
-    
+    resizePopulation(children, kept, kept, config.dimension, config.minXi, config.maxXi);
+    for(int begin=0; begin<kept; )
+    {
+        if(!missed[begin])
+        {
+            begin += 1;
+            continue;
+        }
+        int end = begin;
+        while(end < kept && missed[end]) end += 1;
+        evaluateParallel(children, begin, end);
+        for(int i=begin; i<end; i++) cache.insert(children[i], children[i].getEval());
+        begin = end;
+    }
+}
+
+template <typename Population>
+void breedChildren(Population& population, std::vector<int>& parentIdx, Population& children, int numChildren,
+                   const Config& config, Context& context)
+{   // the first numChildren parents each pair with another, randomly chosen parent to breed a child with
+    // the configured crossover and boundary handling (see lib/operators.hpp), a fixed number of draws
+    // per child. The children are left unevaluated
+    const int dimension = config.dimension;
+    resizePopulation(children, numChildren, population.size(), dimension, config.minXi, config.maxXi);
+    Philox& gen = context.generator();
+    Breeder breeder(config.crossover, config.boundaryHandling, context.mutationScale * config.breedingVarianceScale,
+                    context.mutationScale * config.blendAlpha, config.minXi, config.maxXi, gen);
+    for(int i=0; i<numChildren; i++)
+    {
+        // the other parent is any candidate but this one, from a single draw
+        int other = intRand(0, parentIdx.size() - 2, gen);
+        if(other >= i) other += 1;
+        breeder.breed(population[parentIdx[i]], population[parentIdx[other]], children[i], dimension);
+    }
+}
+
+template <typename Population>
+void getChildren(Population& population, std::vector<int>& parentIdx, Population& children,
+                 const Config& config, Context& context)
+{   // breed and evaluate a child per parent, no children without 2 parents and no more than the
+    // evaluation budget still allows. With a cache every candidate is bred, and only those it misses
+    // are charged (see evaluateCached)
+    FitnessCache* cache = context.fitnessCache;
+    int numChildren = parentIdx.size() < 2 ? 0 : cache ? parentIdx.size() : context.acquireEvaluations(parentIdx.size());
+    breedChildren(population, parentIdx, children, numChildren, config, context);
+    if(!cache)
+    {
+        evaluateParallel(children, 0, children.size()); // score the whole generation at once
+        return;
+    }
+    evaluateCached(children, *cache, config, context);
+}
+
+template <typename Population>
+Population getChildren(Population& population, std::vector<int>& parentIdx, 
+                       const Config& config)
+{   // allocating form, for the ProblemCtx path
+    Population children = makePopulation<Population>(0, config.dimension, config.minXi, config.maxXi);
+    getChildren(population, parentIdx, children, config, threadContext());
     return children;
 }
 
-void updatePopulation(std::vector<soln>& population, std::vector<soln>& children, 
-                      std::vector<std::pair<float, int>> sortedIdx, 
-                      std::unordered_map<std::string, float>& parameters)
+template <typename Population>
+void updatePopulation(Population& population, Population& children, 
+                      const std::vector<std::pair<float, int>>& sortedIdx, 
+                      const Config& config)
 {   // update the current population by replacing the worst soln with new child soln
     for(int i=0; i<children.size(); i++)
     {
@@ -191,21 +611,101 @@ void updatePopulation(std::vector<soln>& population, std::vector<soln>& children
     }
 }
 
-bool endSearch(std::unordered_map<std::string, float>& parameters)
-{   // end when computational budget is exceeded
-    return Schwefel::num_of_evaluations > parameters["max_eval"];
+template <typename Population>
+void updatePopulation(Population& population, Population& children, Ranking& ranking,
+                      const Config& config)
+{   // replace the worst soln with new child soln, then merge the children into the ranking
+    updatePopulation(population, children, ranking.sorted(), config);
+    ranking.replaceWorst(children.size(), [&](int i){ return children[i].getEval(); });
+}
+
+template <typename Population>
+void updatePopulationByValue(Population& population, Population& children, 
+                             std::vector<std::pair<float, int>> sortedIdx, 
+                             const Config& config)
+{   // signature of ProblemCtx::updatePopulation
+    updatePopulation(population, children, sortedIdx, config);
+}
+
+bool endSearch(const Config& config)
+{   // no problem specific stopping rule, the GA stops at its evaluation budget ("max_eval")
+    return false;
 }
 
-// store the problem specific methods for the GA core to run on
-static ProblemCtx<soln> problemCtx = {
-    .setRandomGenerator = &setThreadRandomGenerator,
-    .getRandomSolutions = &getInitialPopulation,
-    .getParentIdx = &getParentIdx,
-    .getChildren = &getChildren,
-    .updatePopulation = &updatePopulation,
-    .endSearch = &endSearch
+template <typename T, typename Population>
+class Problem
+{   // Schwefel's function through the compile-time interface of GA<Problem> (see lib/problem.hpp)
+private:
+    Config _config;
+    RankSelector _selector; // its tables persist across generations, each thread has its own copy
+    Context _context;       // lent by the GA, see Context
+
+public:
+    typedef T solution_type;
+    typedef Population population_type;
+
+    explicit Problem(const Config& config)
+        : _config(config), _selector(config.selectionMethod, config.tournamentSize) {}
+
+    void setRandomGenerator(Philox* gen){ _context.randomGen = gen; }
+
+    void setEvaluationQuota(EvaluationQuota* quota){ _context.evaluationQuota = quota; }
+
+    void setFitnessCache(FitnessCache* cache){ _context.fitnessCache = cache; }
+
+    void setMutationScale(float scale){ _context.mutationScale = scale; }
+
+    Population getRandomSolutions(int size){ return getInitialPopulation<Population>(size, _config, _context); }
+
+    void getRandomSolutions(int size, Population& solutions)
+    {   // in place, for restarts: the GA charges the quota itself
+        Schwefel::getRandomSolutions(size, solutions, _config, _context);
+    }
+
+    void getParentIdx(Population& population, int rangeStart, int rangeEnd,
+                      std::vector<int>& parentIdx, Ranking& ranking)
+    {
+        Schwefel::getParentIdx(population, rangeStart, rangeEnd, parentIdx, ranking, _selector, _config, _context);
+    }
+
+    void getChildren(Population& population, std::vector<int>& parentIdx, Population& children)
+    {
+        Schwefel::getChildren(population, parentIdx, children, _config, _context);
+    }
+
+    void breedChildren(Population& population, std::vector<int>& parentIdx, Population& children)
+    {   // for "steady state" runs, the GA charges and evaluates the children itself
+        Schwefel::breedChildren(population, parentIdx, children, parentIdx.size() < 2 ? 0 : parentIdx.size(),
+                                _config, _context);
+    }
+
+    void evaluateSolution(T& s) const { s.doEval(); }
+
+    void updatePopulation(Population& population, Population& children, Ranking& ranking)
+    {
+        Schwefel::updatePopulation(population, children, ranking, _config);
+    }
+
+    bool endSearch(){ return Schwefel::endSearch(_config); }
 };
 
+template <typename T, typename Population>
+ProblemCtx<T, Population, const Config> makeProblemCtx()
+{   // the problem specific methods instantiated for one dimension and population layout, eg.
+    // makeProblemCtx<soln<6>, std::vector<soln<6>>>() (array of structs, the reference layout) or
+    // makeProblemCtx<soln<6>, SoA<6>>() (structure of arrays). Kept for the function-pointer path,
+    // GA(problemCtx, config, gaConfig) runs it through ProblemCtxAdapter
+    return {
+        .setRandomGenerator = &setThreadRandomGenerator,
+        .setEvaluationQuota = &setThreadEvaluationQuota,
+        .getRandomSolutions = &getInitialPopulation<Population>,
+        .getParentIdx = &getParentIdx<Population>,
+        .getChildren = &getChildren<Population>,
+        .updatePopulation = &updatePopulationByValue<Population>,
+        .endSearch = &endSearch
+    };
+}
+
 } // namespace Schwefel
 
-#endif // INCLUDE_SCHWEFEL
\ No newline at end of file
+#endif // INCLUDE_SCHWEFEL
@@ -0,0 +1,37 @@
+import struct
+import zlib
+import numpy as np
+
+# reader for the population snapshots written by lib/snapshot.hpp ("print every"), text or binary
+
+MAGIC = b"GASNAP\0\0"
+HEADER = struct.Struct("<8sIIqii")  # magic, version, flags, iteration, rows, dimension
+
+def readBinary(path):
+    # returns (iteration, data) where data[:, :-1] holds the coordinates and data[:, -1] the objective
+    with open(path, "rb") as f:
+        buffer = f.read()
+    magic, version, flags, iteration, rows, dimension = HEADER.unpack_from(buffer, 0)
+    if magic != MAGIC or version != 1:
+        raise ValueError(path + " is not a version 1 snapshot")
+    offset = HEADER.size
+    columns = []
+    for c in range(dimension + 1):
+        if flags & 1:
+            (length,) = struct.unpack_from("<I", buffer, offset)
+            offset += 4
+            planes = np.frombuffer(zlib.decompress(buffer[offset:offset+length]), dtype=np.uint8)
+            offset += length
+            # undo the byte shuffle: plane b holds byte b of every float
+            column = planes.reshape(4, rows).T.copy().view("<f4").reshape(rows)
+        else:
+            column = np.frombuffer(buffer, dtype="<f4", count=rows, offset=offset)
+            offset += 4 * rows
+        columns.append(column)
+    return iteration, np.stack(columns, axis=1)
+
+def loadPopulation(path):
+    # the population as an array of rows x1, ..., xn, f, the same as np.loadtxt on a text snapshot
+    if path.endswith(".gasnap"):
+        return readBinary(path)[1]
+    return np.loadtxt(path, delimiter=',', ndmin=2)
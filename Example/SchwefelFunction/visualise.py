@@ -3,6 +3,7 @@ import matplotlib.pyplot as plt
 from mpl_toolkits.mplot3d import Axes3D
 from matplotlib import cm
 from matplotlib.ticker import LinearLocator
+from snapshot import loadPopulation
 
 def SchwefelFunct(x):
     return np.sum(-x * np.sin(np.sqrt(np.abs(x))))
@@ -29,7 +30,7 @@ def schwefel2D():
     plt.savefig("result.png")
 
 def visualisePopulation(path, savepath):
-    data = np.loadtxt(path, delimiter=',')
+    data = loadPopulation(path) # text or binary (.gasnap) snapshot
     cs = plt.contour(X1, X2, f.reshape(X1.shape), 10)
     plt.colorbar(cs, shrink=0.5, aspect=10)
     indexes = [(0, 26), (26, 52), (52, 78), (78, 100)]
@@ -43,13 +44,13 @@ def visualisePopulation(path, savepath):
     print("saved figure at: ", savepath)
 
 def bestSoln(path):
-    data = np.loadtxt(path, delimiter=',')
+    data = loadPopulation(path) # text or binary (.gasnap) snapshot
     print(data[np.argmin(data[:,2])])
 
 # schwefel2D()
 # visualisePopulation("Release/populationInitial.txt", "2d_initial.png")
 # for i in [20, 40, 60, 80, 100]:
-#     datapath = "Release/Results/iter" + str(i) + ".txt"
+#     datapath = "Release/Results/iter" + str(i) + ".txt" # or ".gasnap"
 #     outpath = "2d_iter" + str(i) + ".png"
 #     visualisePopulation(datapath, outpath)
 # visualisePopulation("Release/populationEnd.txt", "2d_End.png")
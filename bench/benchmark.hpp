@@ -0,0 +1,514 @@
+#ifndef INCLUDE_GA_BENCHMARK
+#define INCLUDE_GA_BENCHMARK
+
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <regex>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+#include <unistd.h>
+#include "../third_party/nlohmann/json.hpp"
+
+/* A benchmark harness after Google Benchmark (https://github.com/google/benchmark), kept in the repo
+   so GA_bench builds and runs offline with nothing but the standard library and the vendored json.
+
+   A benchmark is a function of a State that times the body of its loop, the code before the loop is
+   setup and not timed:
+
+       void evaluate(bench::State& state)
+       {
+           Schwefel::soln<6> s(...);
+           for(auto _ : state) bench::doNotOptimize(s.evaluateObjective());
+           state.setItemsProcessed(state.iterations());
+       }
+       bench::add("evaluate", evaluate)->args({1000, 2})->args({10000, 2})->argNames({"size", "threads"});
+
+   The loop runs until it took --benchmark_min_time seconds, growing the iteration count the way
+   Google Benchmark does, unless the benchmark fixes iterations(n). state.range(k) is the k-th of the
+   current args, pauseTiming() / resumeTiming() leave per-iteration setup out. Anything else is
+   reported through state.counters["name"] = Counter(value, flags): Counter::isRate divides the value
+   by the seconds timed, Counter::avgIterations by the iterations. Times and rates are wall time; cpu
+   time is that of the whole process, so it includes the pool's workers.
+
+   bench::main(argc, argv) runs every benchmark and prints a table. --benchmark_out=file writes the
+   results in Google Benchmark's json format, so two builds can be diffed with bench/compare.py (or
+   Google's tools/compare.py).
+
+       --benchmark_filter=regex       only the runs whose name matches (default: all)
+       --benchmark_min_time=seconds   (default 0.5) least time a run is timed for
+       --benchmark_repetitions=n      (default 1) runs of each benchmark, reported with their mean,
+                                      median and stddev
+       --benchmark_out=file           the json report
+       --benchmark_list_tests         print the names and exit */
+
+namespace bench
+{
+    enum class TimeUnit { nanosecond, microsecond, millisecond };
+
+    inline const char* unitName(TimeUnit unit)
+    {
+        switch(unit)
+        {
+            case TimeUnit::microsecond: return "us";
+            case TimeUnit::millisecond: return "ms";
+            default: return "ns";
+        }
+    }
+
+    inline double unitNs(TimeUnit unit)
+    {
+        switch(unit)
+        {
+            case TimeUnit::microsecond: return 1e3;
+            case TimeUnit::millisecond: return 1e6;
+            default: return 1;
+        }
+    }
+
+    struct Counter
+    {
+        enum Flags { plain = 0, isRate = 1, avgIterations = 2 };
+
+        double value;
+        int flags;
+
+        Counter(double value = 0, int flags = plain) : value(value), flags(flags) {}
+    };
+
+    template <typename V>
+    inline void doNotOptimize(V const& value)
+    {   // the compiler must assume value is read, so computing it cannot be optimised away
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    template <typename V>
+    inline void doNotOptimize(V& value)
+    {
+        asm volatile("" : "+r,m"(value) : : "memory");
+    }
+
+    inline void clobberMemory() { asm volatile("" : : : "memory"); }
+
+    inline double processCpuNs()
+    {
+        timespec t;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+        return t.tv_sec * 1e9 + t.tv_nsec;
+    }
+
+    class State
+    {
+    private:
+        std::vector<long> _args;
+        long _iterations;
+        bool _timing = false;
+        std::chrono::steady_clock::time_point _realStart;
+        double _cpuStart = 0;
+        double _realNs = 0;
+        double _cpuNs = 0;
+        double _items = 0;
+        std::string _label;
+
+        void startTimer()
+        {
+            _timing = true;
+            _realStart = std::chrono::steady_clock::now();
+            _cpuStart = processCpuNs();
+        }
+
+        void stopTimer()
+        {
+            if(!_timing) return;
+            _realNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - _realStart).count();
+            _cpuNs += processCpuNs() - _cpuStart;
+            _timing = false;
+        }
+
+    public:
+        std::map<std::string, Counter> counters;
+
+        struct Value
+        {   // user-provided, so the loop variable never counts as unused
+            Value() {}
+            ~Value() {}
+        };
+
+        struct Iterator
+        {   // counts the loop down, the timer stops when it ends
+            State* state;
+            long left;
+
+            bool operator!=(const Iterator&)
+            {
+                if(left > 0) return true;
+                state->stopTimer();
+                return false;
+            }
+
+            void operator++() { left -= 1; }
+
+            Value operator*() const { return Value(); }
+        };
+
+        State(const std::vector<long>& args, long iterations) : _args(args), _iterations(iterations) {}
+
+        Iterator begin()
+        {
+            startTimer();
+            return Iterator{this, _iterations};
+        }
+
+        Iterator end() { return Iterator{this, 0}; }
+
+        long range(int k = 0) const { return _args.at(k); }
+
+        long iterations() const { return _iterations; }
+
+        void pauseTiming() { stopTimer(); }
+
+        void resumeTiming() { startTimer(); }
+
+        void setItemsProcessed(double items) { _items = items; }
+
+        void setLabel(const std::string& label) { _label = label; }
+
+        double realNs() const { return _realNs; }
+
+        double cpuNs() const { return _cpuNs; }
+
+        double items() const { return _items; }
+
+        const std::string& label() const { return _label; }
+    };
+
+    class Benchmark
+    {
+    private:
+        std::string _name;
+        std::function<void(State&)> _run;
+        std::vector<std::vector<long>> _args;
+        std::vector<std::string> _argNames;
+        long _iterations = 0;
+        double _minTime = 0;
+        TimeUnit _unit = TimeUnit::nanosecond;
+
+    public:
+        Benchmark(const std::string& name, std::function<void(State&)> run) : _name(name), _run(std::move(run)) {}
+
+        Benchmark* args(const std::vector<long>& values) { _args.push_back(values); return this; }
+
+        Benchmark* argNames(const std::vector<std::string>& names) { _argNames = names; return this; }
+
+        Benchmark* iterations(long n) { _iterations = n; return this; }
+
+        Benchmark* minTime(double seconds) { _minTime = seconds; return this; }
+
+        Benchmark* unit(TimeUnit unit) { _unit = unit; return this; }
+
+        const std::string& name() const { return _name; }
+
+        const std::function<void(State&)>& run() const { return _run; }
+
+        std::vector<std::vector<long>> argSets() const { return _args.empty() ? std::vector<std::vector<long>>{{}} : _args; }
+
+        long fixedIterations() const { return _iterations; }
+
+        double fixedMinTime() const { return _minTime; }
+
+        TimeUnit timeUnit() const { return _unit; }
+
+        std::string runName(const std::vector<long>& args) const
+        {   // name/arg:value/... as Google Benchmark names its runs
+            std::string name = _name;
+            for(int k=0; k<args.size(); k++)
+            {
+                name += '/';
+                if(k < _argNames.size()) name += _argNames[k] + ':';
+                name += std::to_string(args[k]);
+            }
+            return name;
+        }
+    };
+
+    inline std::vector<std::unique_ptr<Benchmark>>& registry()
+    {
+        static std::vector<std::unique_ptr<Benchmark>> benchmarks;
+        return benchmarks;
+    }
+
+    inline Benchmark* add(const std::string& name, std::function<void(State&)> run)
+    {
+        registry().push_back(std::make_unique<Benchmark>(name, std::move(run)));
+        return registry().back().get();
+    }
+
+    inline nlohmann::json& context()
+    {   // extra fields of the report's "context", eg. the build's options
+        static nlohmann::json c = nlohmann::json::object();
+        return c;
+    }
+
+    struct Result
+    {   // one timed run, times per iteration in the benchmark's unit
+        std::string name;
+        long iterations = 0;
+        double realTime = 0;
+        double cpuTime = 0;
+        std::map<std::string, double> counters;
+        std::string label;
+    };
+
+    inline Result measure(const Benchmark& benchmark, const std::vector<long>& args, double minTime)
+    {   // runs the benchmark with more iterations until it takes minTime, or its fixed iterations
+        const long maxIterations = 1000000000;
+        if(benchmark.fixedMinTime() > 0) minTime = benchmark.fixedMinTime();
+        long n = benchmark.fixedIterations() > 0 ? benchmark.fixedIterations() : 1;
+        while(true)
+        {
+            State state(args, n);
+            benchmark.run()(state);
+            const double seconds = state.realNs() / 1e9;
+            if(benchmark.fixedIterations() > 0 || seconds >= minTime || n >= maxIterations)
+            {
+                Result r;
+                r.name = benchmark.runName(args);
+                r.iterations = n;
+                r.realTime = state.realNs() / n / unitNs(benchmark.timeUnit());
+                r.cpuTime = state.cpuNs() / n / unitNs(benchmark.timeUnit());
+                if(state.items() > 0) r.counters["items_per_second"] = state.items() / seconds;
+                for(auto& counter : state.counters)
+                {
+                    double value = counter.second.value;
+                    if(counter.second.flags & Counter::isRate) value /= seconds;
+                    if(counter.second.flags & Counter::avgIterations) value /= n;
+                    r.counters[counter.first] = value;
+                }
+                r.label = state.label();
+                return r;
+            }
+            // aim 40% past minTime, by at most 10x when the last run was too short to tell
+            double multiplier = minTime * 1.4 / std::max(seconds, 1e-9);
+            if(seconds / minTime <= 0.1) multiplier = std::min(multiplier, 10.0);
+            n = std::min(maxIterations, std::max(static_cast<long>(n * multiplier), n + 1));
+        }
+    }
+
+    inline nlohmann::json toJson(const Result& r, const Benchmark& benchmark, int family, int instance,
+                                 int repetitions, int repetition, const std::string& aggregate = "")
+    {   // a "benchmarks" entry of Google Benchmark's json report
+        nlohmann::json j;
+        j["name"] = aggregate.empty() ? r.name : r.name + "_" + aggregate;
+        j["family_index"] = family;
+        j["per_family_instance_index"] = instance;
+        j["run_name"] = r.name;
+        j["run_type"] = aggregate.empty() ? "iteration" : "aggregate";
+        j["repetitions"] = repetitions;
+        if(aggregate.empty()) j["repetition_index"] = repetition;
+        else j["aggregate_name"] = aggregate;
+        j["threads"] = 1;
+        j["iterations"] = r.iterations;
+        j["real_time"] = r.realTime;
+        j["cpu_time"] = r.cpuTime;
+        j["time_unit"] = unitName(benchmark.timeUnit());
+        for(auto& counter : r.counters) j[counter.first] = counter.second;
+        if(!r.label.empty()) j["label"] = r.label;
+        return j;
+    }
+
+    inline std::vector<std::pair<std::string, Result>> aggregates(const std::vector<Result>& runs)
+    {   // mean, median and stddev of every time and counter over the repetitions
+        std::vector<std::pair<std::string, Result>> out;
+        auto over = [&](auto&& field){
+            std::vector<double> v;
+            for(const Result& r : runs) v.push_back(field(r));
+            return v;
+        };
+        auto mean = [](std::vector<double> v){
+            double s = 0;
+            for(double x : v) s += x;
+            return s / v.size();
+        };
+        auto median = [](std::vector<double> v){
+            std::sort(v.begin(), v.end());
+            return v.size() % 2 ? v[v.size()/2] : (v[v.size()/2 - 1] + v[v.size()/2]) / 2;
+        };
+        auto stddev = [&](std::vector<double> v){
+            const double m = mean(v);
+            double s = 0;
+            for(double x : v) s += (x - m) * (x - m);
+            return v.size() > 1 ? std::sqrt(s / (v.size() - 1)) : 0.0;
+        };
+        for(auto& statistic : std::vector<std::pair<std::string, std::function<double(std::vector<double>)>>>{
+                {"mean", mean}, {"median", median}, {"stddev", stddev}})
+        {
+            Result a;
+            a.name = runs.front().name;
+            a.iterations = runs.size();
+            a.realTime = statistic.second(over([](const Result& r){ return r.realTime; }));
+            a.cpuTime = statistic.second(over([](const Result& r){ return r.cpuTime; }));
+            for(auto& counter : runs.front().counters)
+            {
+                const std::string name = counter.first;
+                a.counters[name] = statistic.second(over([&](const Result& r){ return r.counters.at(name); }));
+            }
+            out.push_back({statistic.first, a});
+        }
+        return out;
+    }
+
+    inline void printRow(const Result& r, const std::string& name, TimeUnit unit, int width)
+    {
+        std::ostringstream line;
+        line << std::left << std::setw(width) << name << std::right << std::fixed << std::setprecision(2)
+             << std::setw(13) << r.realTime << ' ' << std::setw(2) << unitName(unit)
+             << std::setw(13) << r.cpuTime << ' ' << std::setw(2) << unitName(unit)
+             << std::setw(13) << r.iterations;
+        line.unsetf(std::ios::fixed);
+        line << std::setprecision(4);
+        for(auto& counter : r.counters) line << ' ' << counter.first << '=' << counter.second;
+        if(!r.label.empty()) line << ' ' << r.label;
+        std::cout << line.str() << std::endl;
+    }
+
+    inline int main(int argc, char* argv[])
+    {   // runs the registered benchmarks, see the top of this file for the flags
+        std::string filter = ".";
+        std::string outPath;
+        double minTime = 0.5;
+        int repetitions = 1;
+        bool list = false;
+        for(int a=1; a<argc; a++)
+        {
+            const std::string arg = argv[a];
+            auto value = [&](const std::string& flag, std::string& to){
+                if(arg.rfind(flag + "=", 0) != 0) return false;
+                to = arg.substr(flag.size() + 1);
+                return true;
+            };
+            std::string v;
+            try
+            {
+                if(value("--benchmark_filter", v)) filter = v;
+                else if(value("--benchmark_out", v)) outPath = v;
+                else if(value("--benchmark_min_time", v)) minTime = std::stod(v);
+                else if(value("--benchmark_repetitions", v)) repetitions = std::stoi(v);
+                else if(arg == "--benchmark_list_tests") list = true;
+                else throw std::invalid_argument(arg);
+            }catch(const std::exception&)
+            {
+                std::cout << "unrecognised argument " << arg << '\n'
+                          << "usage: " << argv[0] << " [--benchmark_filter=regex] [--benchmark_min_time=seconds]\n"
+                          << "       [--benchmark_repetitions=n] [--benchmark_out=file.json] [--benchmark_list_tests]\n";
+                return 1;
+            }
+        }
+        if(repetitions < 1 || minTime < 0)
+        {
+            std::cout << "--benchmark_repetitions must be at least 1 and --benchmark_min_time not negative\n";
+            return 1;
+        }
+        std::regex match;
+        try
+        {
+            match = std::regex(filter);
+        }catch(const std::regex_error& e)
+        {
+            std::cout << "invalid --benchmark_filter " << filter << ": " << e.what() << '\n';
+            return 1;
+        }
+
+        struct Instance
+        {
+            const Benchmark* benchmark;
+            std::vector<long> args;
+            int family;
+            int index;
+        };
+        std::vector<Instance> instances;
+        int width = 10;
+        for(int f=0; f<registry().size(); f++)
+        {
+            int index = 0;
+            for(auto& args : registry()[f]->argSets())
+            {
+                const std::string name = registry()[f]->runName(args);
+                if(!std::regex_search(name, match)) continue;
+                instances.push_back(Instance{registry()[f].get(), args, f, index++});
+                width = std::max<int>(width, name.size() + (repetitions > 1 ? 7 : 0));
+            }
+        }
+        if(list)
+        {
+            for(const Instance& instance : instances) std::cout << instance.benchmark->runName(instance.args) << '\n';
+            return 0;
+        }
+
+        char host[256] = "";
+        gethostname(host, sizeof(host) - 1);
+        std::time_t now = std::time(nullptr);
+        char date[64];
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+        nlohmann::json report;
+        report["context"] = context();
+        report["context"]["date"] = date;
+        report["context"]["host_name"] = host;
+        report["context"]["executable"] = argv[0];
+        report["context"]["num_cpus"] = std::thread::hardware_concurrency();
+#ifdef NDEBUG
+        report["context"]["library_build_type"] = "release";
+#else
+        report["context"]["library_build_type"] = "debug";
+#endif
+        report["benchmarks"] = nlohmann::json::array();
+
+        std::cout << date << "\nRunning " << argv[0] << " on " << std::thread::hardware_concurrency() << " cpus\n"
+                  << std::string(width + 45, '-') << '\n'
+                  << std::left << std::setw(width) << "Benchmark" << std::right << std::setw(16) << "Time"
+                  << std::setw(16) << "CPU" << std::setw(13) << "Iterations" << " Counters\n"
+                  << std::string(width + 45, '-') << std::endl;
+        for(const Instance& instance : instances)
+        {
+            const Benchmark& benchmark = *instance.benchmark;
+            std::vector<Result> runs;
+            for(int r=0; r<repetitions; r++)
+            {
+                runs.push_back(measure(benchmark, instance.args, minTime));
+                printRow(runs.back(), runs.back().name, benchmark.timeUnit(), width);
+                report["benchmarks"].push_back(toJson(runs.back(), benchmark, instance.family, instance.index,
+                                                      repetitions, r));
+            }
+            if(repetitions < 2) continue;
+            for(auto& aggregate : aggregates(runs))
+            {
+                printRow(aggregate.second, aggregate.second.name + "_" + aggregate.first, benchmark.timeUnit(), width);
+                report["benchmarks"].push_back(toJson(aggregate.second, benchmark, instance.family, instance.index,
+                                                      repetitions, 0, aggregate.first));
+            }
+        }
+
+        if(!outPath.empty())
+        {
+            std::ofstream out(outPath, std::ios::out|std::ios::trunc);
+            out << report.dump(2) << '\n';
+            if(!out)
+            {
+                std::cout << "cannot write " << outPath << '\n';
+                return 1;
+            }
+            std::cout << "results written to " << outPath << '\n';
+        }
+        return 0;
+    }
+} // namespace bench
+
+#endif // INCLUDE_GA_BENCHMARK
@@ -0,0 +1,52 @@
+import json
+import sys
+
+# compares two GA_bench json reports (bench/benchmark.hpp), eg. of two builds:
+#   python3 bench/compare.py before.json after.json
+# every benchmark in both, by its median when run with repetitions, as the change of its time and
+# of every counter from the first report to the second (negative time is faster)
+
+def loadRuns(path):
+    # returns {run name: entry}, the median aggregate where there is one
+    with open(path) as f:
+        report = json.load(f)
+    runs = {}
+    for entry in report["benchmarks"]:
+        if entry["run_type"] == "aggregate" and entry["aggregate_name"] != "median":
+            continue
+        if entry["run_type"] == "iteration" and entry["repetitions"] > 1:
+            continue
+        runs[entry["run_name"]] = entry
+    return runs
+
+def change(old, new):
+    if old == 0:
+        return "    n/a"
+    return format((new - old) / abs(old), "+7.1%")
+
+STANDARD = {"name", "family_index", "per_family_instance_index", "run_name", "run_type", "repetitions",
+            "repetition_index", "aggregate_name", "threads", "iterations", "real_time", "cpu_time",
+            "time_unit", "label"}
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        sys.exit("usage: compare.py before.json after.json")
+    before = loadRuns(sys.argv[1])
+    after = loadRuns(sys.argv[2])
+    names = [name for name in before if name in after]
+    width = max([len(name) for name in names] + [9])
+    print("Benchmark".ljust(width), "     Time      CPU  Counters")
+    for name in names:
+        old, new = before[name], after[name]
+        line = name.ljust(width) + "  " + change(old["real_time"], new["real_time"]) + "  " + \
+               change(old["cpu_time"], new["cpu_time"])
+        for counter in sorted(set(old) - STANDARD):
+            if counter in new and isinstance(old[counter], (int, float)):
+                line += "  " + counter + " " + change(old[counter], new[counter]).strip()
+        print(line)
+    for name in before:
+        if name not in after:
+            print(name.ljust(width), "  only in", sys.argv[1])
+    for name in after:
+        if name not in before:
+            print(name.ljust(width), "  only in", sys.argv[2])
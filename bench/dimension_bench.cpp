@@ -0,0 +1,89 @@
+/* Compares the runtime-dimension soln<0> against the fixed-size soln<D> it replaces when the
+   dimension is not one of SCHWEFEL_DIMENSIONS, for both population layouts.
+
+   usage: GA_bench_dimension [population size] [repeats] */
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include "../Example/SchwefelFunction/problem.hpp"
+
+template <typename F>
+double medianMs(int repeats, F&& f)
+{   // median wall time of f() over repeats runs
+    std::vector<double> t;
+    for(int r=0; r<repeats; r++)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        f();
+        auto finish = std::chrono::high_resolution_clock::now();
+        t.push_back(std::chrono::duration<double, std::milli>(finish-start).count());
+    }
+    std::sort(t.begin(), t.end());
+    return t[t.size()/2];
+}
+
+template <typename T, typename Population>
+std::pair<double, double> measure(int dimension, int size, int repeats)
+{   // (batch evaluation, breed + replace a twentieth of the population) median times in ms
+    Schwefel::Config parameters;
+    parameters.dimension = dimension;
+    parameters.minXi = -500;
+    parameters.maxXi = 500;
+    parameters.selectionPressure = 2;
+    parameters.breedingVarianceScale = 0.5;
+    Philox generator(42);
+    Schwefel::setThreadRandomGenerator(&generator);
+    Population population = Schwefel::getInitialPopulation<Population>(size, parameters);
+    double eval = medianMs(repeats, [&]{ Schwefel::evaluateBatch(population, 0, population.size()); });
+
+    // a fixed parent set, so both paths breed the same number of children
+    std::vector<int> parents;
+    std::vector<std::pair<float, int>> sortedIdx;
+    for(int i=0; i<size; i++)
+    {
+        if(i < size/20) parents.push_back(i);
+        sortedIdx.push_back({0.0f, i});
+    }
+    double generation = medianMs(repeats, [&]{
+        Population children = Schwefel::getChildren(population, parents, parameters);
+        Schwefel::updatePopulation(population, children, sortedIdx, parameters);
+    });
+    Schwefel::setThreadRandomGenerator(nullptr);
+    return {eval, generation};
+}
+
+template <int D>
+void compare(int size, int repeats)
+{
+    typedef Schwefel::soln<D> fixed;
+    typedef Schwefel::soln<0> dynamic;
+    auto aosFixed = measure<fixed, std::vector<fixed>>(D, size, repeats);
+    auto aosDynamic = measure<dynamic, std::vector<dynamic>>(D, size, repeats);
+    auto soaFixed = measure<fixed, SoAPopulation<fixed>>(D, size, repeats);
+    auto soaDynamic = measure<dynamic, SoAPopulation<dynamic>>(D, size, repeats);
+
+    auto row = [](const std::string& name, double fixedMs, double dynamicMs){
+        std::cout << "  " << name << ": fixed " << fixedMs << "ms, runtime " << dynamicMs << "ms ("
+                  << (dynamicMs / fixedMs - 1) * 100 << "%)\n";
+    };
+    std::cout << "dimension " << D << '\n';
+    row("AoS evaluate  ", aosFixed.first, aosDynamic.first);
+    row("AoS breed     ", aosFixed.second, aosDynamic.second);
+    row("SoA evaluate  ", soaFixed.first, soaDynamic.first);
+    row("SoA breed     ", soaFixed.second, soaDynamic.second);
+}
+
+int main(int argc, char *argv[])
+{
+    int size = argc > 1 ? std::stoi(argv[1]) : 20000;
+    int repeats = argc > 2 ? std::stoi(argv[2]) : 21;
+    std::cout << "population " << size << ", median of " << repeats << " repeats, isa "
+              << simd::isaName(simd::activeIsa()) << '\n';
+    compare<6>(size, repeats);
+    compare<30>(size, repeats);
+    compare<100>(size, repeats);
+    return 0;
+}
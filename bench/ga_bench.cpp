@@ -0,0 +1,287 @@
+/* Micro benchmarks of every stage of a generation and macro benchmarks of whole optimise() runs on
+   Schwefel's function, on the harness in benchmark.hpp. Diff two builds with
+
+       GA_bench --benchmark_out=before.json   (then rebuild)   GA_bench --benchmark_out=after.json
+       python3 bench/compare.py before.json after.json
+
+   micro  evaluateObjective  one solution, the scalar path
+          evaluateBatch      a whole population, the batched (SIMD) path the GA uses
+          getParentIdx       ranking selection on a ranked population
+          getChildren        breeding and evaluating "children" children
+          updatePopulation   replacing the worst and re-ranking
+          migration          a migration round of every island over each topology
+   macro  optimise           a run of "max_eval" = population + 100000 evaluations, a different seed every
+                             iteration, reporting evaluations/s (of optimise(), the initial population is
+                             not timed), the mean best fitness, and the time until any island first bred a
+                             child within 20% of the optimum (time_to_target_ms, averaged over the runs that
+                             got there, target_reached the fraction that did; -1 when none did)
+
+   usage: GA_bench [--benchmark_filter=regex] [--benchmark_min_time=seconds] [--benchmark_repetitions=n]
+                   [--benchmark_out=file.json] [--benchmark_list_tests] */
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include "benchmark.hpp"
+#include "../Example/SchwefelFunction/problem.hpp"
+
+template <int D>
+Schwefel::Config problemConfig()
+{
+    return Schwefel::Config{D, -500, 500, 2, 0.5};
+}
+
+template <int D>
+void evaluateObjective(bench::State& state)
+{
+    Philox generator(42);
+    Schwefel::soln<D> s(D, -500, 500, generator);
+    for(auto _ : state)
+    {
+        s.doEval();
+        bench::doNotOptimize(s.getEval());
+    }
+    state.setItemsProcessed(state.iterations());
+}
+
+template <typename Population, int D>
+void evaluateBatch(bench::State& state)
+{
+    const int size = state.range(0);
+    Schwefel::Context context;
+    Population population = Schwefel::getInitialPopulation<Population>(size, problemConfig<D>(), context);
+    for(auto _ : state)
+    {
+        Schwefel::evaluateBatch(population, 0, population.size());
+        bench::clobberMemory();
+    }
+    state.setItemsProcessed(static_cast<double>(state.iterations()) * size);
+}
+
+template <typename Population, int D>
+void getParentIdx(bench::State& state)
+{
+    const int size = state.range(0);
+    const Schwefel::Config config = problemConfig<D>();
+    Schwefel::Context context;
+    Population population = Schwefel::getInitialPopulation<Population>(size, config, context);
+    Ranking ranking;
+    RankSelector selector(config.selectionMethod, config.tournamentSize);
+    std::vector<int> parents;
+    double chosen = 0;
+    for(auto _ : state)
+    {
+        Schwefel::getParentIdx(population, 0, size, parents, ranking, selector, config, context);
+        chosen += parents.size();
+    }
+    state.counters["parents"] = bench::Counter(chosen, bench::Counter::avgIterations);
+    state.setItemsProcessed(state.iterations());
+}
+
+template <typename Population, int D>
+void getChildren(bench::State& state)
+{
+    const int size = state.range(0);
+    const int numChildren = state.range(1);
+    const Schwefel::Config config = problemConfig<D>();
+    Schwefel::Context context;
+    Population population = Schwefel::getInitialPopulation<Population>(size, config, context);
+    Population children = Schwefel::makePopulation<Population>(0, D, config.minXi, config.maxXi);
+    std::vector<int> parents;
+    for(int i=0; i<numChildren; i++) parents.push_back(i);
+    for(auto _ : state)
+    {
+        Schwefel::getChildren(population, parents, children, config, context);
+        bench::clobberMemory();
+    }
+    state.setItemsProcessed(static_cast<double>(state.iterations()) * numChildren);
+}
+
+template <typename Population, int D>
+void updatePopulation(bench::State& state)
+{
+    const int size = state.range(0);
+    const int numChildren = state.range(1);
+    const Schwefel::Config config = problemConfig<D>();
+    Schwefel::Context context;
+    Population population = Schwefel::getInitialPopulation<Population>(size, config, context);
+    Population children = Schwefel::getInitialPopulation<Population>(numChildren, config, context);
+    Ranking ranking;
+    ranking.rebuild(population, 0, size);
+    for(auto _ : state)
+    {
+        Schwefel::updatePopulation(population, children, ranking, config);
+        bench::clobberMemory();
+    }
+    state.setItemsProcessed(static_cast<double>(state.iterations()) * numChildren);
+}
+
+template <MigrationTopology topology>
+void migration(bench::State& state)
+{
+    typedef Schwefel::soln<6> soln;
+    const int islands = state.range(0);
+    const int migrants = state.range(1);
+    Philox generator(42);
+    soln migrant(6, -500, 500, generator);
+    MigrationNetwork<soln> network;
+    network.build(islands, topology, migrants, migrant);
+    double received = 0;
+    for(auto _ : state)
+    {
+        for(int i=0; i<islands; i++)
+        {
+            network.beginRound(i, generator);
+            for(int m=0; m<migrants; m++) network.send(i, migrant);
+        }
+        for(int i=0; i<islands; i++)
+        {
+            while(network.receive(i, migrant)) received += 1;
+        }
+    }
+    state.setItemsProcessed(received);
+}
+
+struct TargetWatch
+{   // when the first solution at or below target was bred, shared by every island's copy of the problem
+    float target = 0;
+    std::chrono::steady_clock::time_point start;
+    std::atomic<long long> reachedNs{-1};
+
+    void reset(float best)
+    {   // at the start of optimise(), best is the best of the initial population
+        start = std::chrono::steady_clock::now();
+        reachedNs.store(best <= target ? 0 : -1);
+    }
+
+    void check(float fitness)
+    {
+        if(fitness > target || reachedNs.load(std::memory_order_relaxed) >= 0) return;
+        long long expected = -1;
+        reachedNs.compare_exchange_strong(expected, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                        std::chrono::steady_clock::now() - start).count());
+    }
+};
+
+template <typename Base>
+class TargetProblem : public Base
+{   // Base, with every bred child checked against the watch's target
+private:
+    TargetWatch* _watch;
+
+public:
+    TargetProblem(const Base& base, TargetWatch* watch) : Base(base), _watch(watch) {}
+
+    void getChildren(typename Base::population_type& population, std::vector<int>& parentIdx,
+                     typename Base::population_type& children)
+    {
+        Base::getChildren(population, parentIdx, children);
+        for(int i=0; i<children.size(); i++) _watch->check(children[i].getEval());
+    }
+};
+
+template <typename Population, int D>
+void optimise(bench::State& state)
+{
+    typedef TargetProblem<Schwefel::Problem<typename Population::value_type, Population>> Problem;
+    const int size = state.range(0);
+    const int threads = state.range(1);
+    GAConfig parameters;
+    parameters.maxIterations = INT_MAX;
+    parameters.populationSize = size;
+    parameters.numberOfThreads = threads;
+    parameters.printEvery = INT_MAX;
+    parameters.swapPopulationEvery = 10;
+    parameters.printResults = false;
+    parameters.structureOfArrays = true;
+    parameters.maxEvaluations = size + 100000;
+    parameters.workerThreads = threads;
+    parameters.verbose = false;
+    ThreadPool::shared(threads); // the pool is started before the timing, not by the first run
+
+    TargetWatch watch;
+    watch.target = 0.8f * -418.9829f * D; // 20% short of the global minimum
+    double evaluations = 0;
+    double bestFitness = 0;
+    double targetNs = 0;
+    int reached = 0;
+    long long seed = 1;
+    for(auto _ : state)
+    {
+        state.pauseTiming();
+        parameters.seed = seed++;
+        auto GAinst = std::make_unique<GA<Problem>>(Problem(Schwefel::Problem<typename Population::value_type, Population>(
+                                                                problemConfig<D>()), &watch), parameters);
+        GAinst->generateInitialPopulation();
+        const long initial = GAinst->evaluations();
+        watch.reset(Schwefel::getBestSoln(*GAinst->getPopulation()).getEval());
+        state.resumeTiming();
+
+        GAinst->optimise();
+
+        state.pauseTiming();
+        evaluations += GAinst->evaluations() - initial;
+        bestFitness += Schwefel::getBestSoln(*GAinst->getPopulation()).getEval();
+        if(watch.reachedNs.load() >= 0)
+        {
+            targetNs += watch.reachedNs.load();
+            reached += 1;
+        }
+        GAinst.reset();
+        state.resumeTiming();
+    }
+    state.counters["evaluations_per_second"] = bench::Counter(evaluations, bench::Counter::isRate);
+    state.counters["best_fitness"] = bench::Counter(bestFitness, bench::Counter::avgIterations);
+    state.counters["time_to_target_ms"] = reached > 0 ? targetNs / reached / 1e6 : -1;
+    state.counters["target_reached"] = static_cast<double>(reached) / state.iterations();
+}
+
+template <typename Population, int D>
+void addStages(const std::string& suffix)
+{   // the micro benchmarks of one layout and dimension
+    bench::add("evaluateBatch" + suffix, evaluateBatch<Population, D>)
+        ->args({1000})->args({100000})->argNames({"size"});
+    bench::add("getParentIdx" + suffix, getParentIdx<Population, D>)
+        ->args({1000})->args({100000})->argNames({"size"});
+    bench::add("getChildren" + suffix, getChildren<Population, D>)
+        ->args({1000, 2})->args({1000, 50})->args({100000, 50})->argNames({"size", "children"});
+    bench::add("updatePopulation" + suffix, updatePopulation<Population, D>)
+        ->args({1000, 2})->args({1000, 50})->args({100000, 50})->argNames({"size", "children"});
+}
+
+template <typename Population, int D>
+void addRuns(const std::string& suffix)
+{   // the macro benchmarks of one layout and dimension
+    bench::add("optimise" + suffix, optimise<Population, D>)
+        ->args({1000, 1})->args({1000, 4})->args({10000, 1})->args({10000, 4})
+        ->argNames({"population", "threads"})->unit(bench::TimeUnit::millisecond);
+}
+
+int main(int argc, char *argv[])
+{
+    typedef Schwefel::soln<6> soln6;
+    typedef Schwefel::soln<30> soln30;
+    bench::add("evaluateObjective<6>", evaluateObjective<6>);
+    bench::add("evaluateObjective<30>", evaluateObjective<30>);
+    addStages<std::vector<soln6>, 6>("<AoS,6>");
+    addStages<SoAPopulation<soln6>, 6>("<SoA,6>");
+    addStages<SoAPopulation<soln30>, 30>("<SoA,30>");
+    bench::add("migration<ring>", migration<MigrationTopology::ring>)
+        ->args({4, 1})->args({16, 4})->argNames({"islands", "migrants"});
+    bench::add("migration<torus>", migration<MigrationTopology::torus>)
+        ->args({4, 1})->args({16, 4})->argNames({"islands", "migrants"});
+    bench::add("migration<fullyConnected>", migration<MigrationTopology::fullyConnected>)
+        ->args({4, 1})->args({16, 4})->argNames({"islands", "migrants"});
+    bench::add("migration<random>", migration<MigrationTopology::random>)
+        ->args({4, 1})->args({16, 4})->argNames({"islands", "migrants"});
+    addRuns<std::vector<soln6>, 6>("<AoS,6>");
+    addRuns<SoAPopulation<soln6>, 6>("<SoA,6>");
+    addRuns<SoAPopulation<soln30>, 30>("<SoA,30>");
+
+    bench::context()["isa"] = simd::isaName(simd::activeIsa());
+    bench::context()["ga_profile"] = profile::enabled;
+    return bench::main(argc, argv);
+}
@@ -0,0 +1,142 @@
+/* Compares GA<Problem> specialised on Schwefel::Problem (static dispatch) against the same stages
+   called through a table of function pointers (PointerProblem, only the dispatch differs), over whole
+   optimise() runs. The ProblemCtx pipeline (ProblemCtxAdapter) is timed alongside: its interface
+   sorts the whole population, allocates the children and returns them by value every generation,
+   so its gap to the others is mostly that older pipeline, not the dispatch.
+
+   usage: GA_bench_problem [iterations] [repeats] */
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include "../Example/SchwefelFunction/problem.hpp"
+
+template <typename T, typename Population>
+struct StageTable
+{   // the stages of Schwefel::Problem as plain function pointers
+    typedef Schwefel::Problem<T, Population> Base;
+    void (*getParentIdx)(Base&, Population&, int, int, std::vector<int>&, Ranking&);
+    void (*getChildren)(Base&, Population&, std::vector<int>&, Population&);
+    void (*updatePopulation)(Base&, Population&, Population&, Ranking&);
+    bool (*endSearch)(Base&);
+};
+
+template <typename T, typename Population>
+const StageTable<T, Population>* stageTable()
+{
+    typedef Schwefel::Problem<T, Population> Base;
+    static const StageTable<T, Population> table = {
+        [](Base& p, Population& population, int rangeStart, int rangeEnd, std::vector<int>& parentIdx, Ranking& ranking)
+            { p.getParentIdx(population, rangeStart, rangeEnd, parentIdx, ranking); },
+        [](Base& p, Population& population, std::vector<int>& parentIdx, Population& children)
+            { p.getChildren(population, parentIdx, children); },
+        [](Base& p, Population& population, Population& children, Ranking& ranking)
+            { p.updatePopulation(population, children, ranking); },
+        [](Base& p){ return p.endSearch(); }
+    };
+    return &table;
+}
+
+template <typename T, typename Population>
+class PointerProblem
+{   // Schwefel::Problem with every stage of a generation called through StageTable
+private:
+    Schwefel::Problem<T, Population> _base;
+    const StageTable<T, Population>* _stages;
+
+public:
+    typedef T solution_type;
+    typedef Population population_type;
+
+    PointerProblem(const Schwefel::Config& config, const StageTable<T, Population>* stages)
+        : _base(config), _stages(stages) {}
+
+    void setRandomGenerator(Philox* gen){ _base.setRandomGenerator(gen); }
+
+    void setEvaluationQuota(EvaluationQuota* quota){ _base.setEvaluationQuota(quota); }
+
+    Population getRandomSolutions(int size){ return _base.getRandomSolutions(size); }
+
+    void getParentIdx(Population& population, int rangeStart, int rangeEnd, std::vector<int>& parentIdx, Ranking& ranking)
+    {
+        _stages->getParentIdx(_base, population, rangeStart, rangeEnd, parentIdx, ranking);
+    }
+
+    void getChildren(Population& population, std::vector<int>& parentIdx, Population& children)
+    {
+        _stages->getChildren(_base, population, parentIdx, children);
+    }
+
+    void updatePopulation(Population& population, Population& children, Ranking& ranking)
+    {
+        _stages->updatePopulation(_base, population, children, ranking);
+    }
+
+    bool endSearch(){ return _stages->endSearch(_base); }
+};
+
+template <typename Problem>
+double medianMs(const Problem& problem, const GAConfig& parameters, int repeats)
+{   // median wall time of optimise() over repeats runs, with the GA's progress output discarded
+    std::vector<double> t;
+    for(int r=0; r<repeats; r++)
+    {
+        GA<Problem> GAinst(problem, parameters);
+        GAinst.generateInitialPopulation();
+        std::stringstream discard;
+        std::streambuf* previous = std::cout.rdbuf(discard.rdbuf());
+        auto start = std::chrono::high_resolution_clock::now();
+        GAinst.optimise();
+        auto finish = std::chrono::high_resolution_clock::now();
+        std::cout.rdbuf(previous);
+        t.push_back(std::chrono::duration<double, std::milli>(finish-start).count());
+    }
+    std::sort(t.begin(), t.end());
+    return t[t.size()/2];
+}
+
+template <typename T, typename Population>
+void compare(const std::string& name, const GAConfig& parameters, const Schwefel::Config& config, int repeats)
+{
+    double staticMs = medianMs(Schwefel::Problem<T, Population>(config), parameters, repeats);
+    double pointerMs = medianMs(PointerProblem<T, Population>(config, stageTable<T, Population>()), parameters, repeats);
+    double ctxMs = medianMs(ProblemCtxAdapter<T, Population, const Schwefel::Config>(
+                                Schwefel::makeProblemCtx<T, Population>(), config),
+                            parameters, repeats);
+    std::cout << "  " << name << ": static " << staticMs << "ms, function pointer " << pointerMs << "ms ("
+              << (pointerMs / staticMs - 1) * 100 << "% slower), ProblemCtx pipeline " << ctxMs << "ms ("
+              << (ctxMs / staticMs - 1) * 100 << "% slower)\n";
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 20000;
+    int repeats = argc > 2 ? std::stoi(argv[2]) : 11;
+    for(int size : {20, 100, 1000})
+    {
+        GAConfig parameters;
+        parameters.maxIterations = iterations;
+        parameters.populationSize = size;
+        parameters.numberOfThreads = 1;
+        parameters.printEvery = 1000000000;
+        parameters.swapPopulationEvery = 10;
+        parameters.printResults = false;
+        parameters.structureOfArrays = true;
+        parameters.verbose = false;
+        Schwefel::Config config;
+        config.dimension = 6;
+        config.minXi = -500;
+        config.maxXi = 500;
+        config.selectionPressure = 2;
+        config.breedingVarianceScale = 0.5;
+        std::cout << "population " << size << ", " << iterations << " generations, 1 thread, median of "
+                  << repeats << " repeats\n";
+        typedef Schwefel::soln<6> soln;
+        compare<soln, std::vector<soln>>("AoS", parameters, config, repeats);
+        compare<soln, SoAPopulation<soln>>("SoA", parameters, config, repeats);
+    }
+    return 0;
+}
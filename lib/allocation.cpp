@@ -0,0 +1,45 @@
+#include "allocation.hpp"
+#include <cstdlib>
+#include <new>
+
+#if GA_COUNT_ALLOCATIONS
+
+static thread_local long allocations = 0;
+
+long allocation::threadCount(){
+    return allocations;
+}
+
+static void* countedAlloc(std::size_t size){
+    allocations += 1;
+    if(void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+static void* countedAlignedAlloc(std::size_t size, std::align_val_t align){
+    allocations += 1;
+    std::size_t a = static_cast<std::size_t>(align);
+    if(void* p = std::aligned_alloc(a, (size + a - 1) / a * a)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size){ return countedAlloc(size); }
+void* operator new[](std::size_t size){ return countedAlloc(size); }
+void* operator new(std::size_t size, std::align_val_t align){ return countedAlignedAlloc(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align){ return countedAlignedAlloc(size, align); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+#else
+
+long allocation::threadCount(){
+    return 0;
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef INCLUDE_GA_ALLOCATION
+#define INCLUDE_GA_ALLOCATION
+
+// heap allocation counting, compiled in for debug builds only (the global operator new replacement
+// lives in allocation.cpp). Release builds report allocation::enabled = false and a count of 0.
+#ifndef NDEBUG
+#define GA_COUNT_ALLOCATIONS 1
+#else
+#define GA_COUNT_ALLOCATIONS 0
+#endif
+
+namespace allocation
+{
+    constexpr bool enabled = GA_COUNT_ALLOCATIONS;
+
+    // number of heap allocations made by the calling thread so far
+    long threadCount();
+}
+
+#endif // INCLUDE_GA_ALLOCATION
@@ -0,0 +1,270 @@
+#ifndef INCLUDE_GA_BATCH
+#define INCLUDE_GA_BATCH
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <fstream>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <stdexcept>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <filesystem>
+#include "config.hpp"
+#include "threadpool.hpp"
+#include "utils.hpp"
+
+/* Batch experiments: every point of a parameter grid, for every seed and repeat, run as an
+   independent GA instance inside one process (GA_run --batch sweep.json), so a sweep of thousands
+   of runs starts the process and parses its parameters once instead of once per run.
+
+   A sweep spec is a json object
+
+       "parameters"       the parameters every run starts from, an object or the path of a parameters
+                          json (relative to the spec)
+       "grid"             (default {}) "parameter": [values, ...], every combination is a grid point
+       "seeds"            (default [1]) a list of seeds, or {"first": s, "count": n} for s, ..., s+n-1
+       "repeats"          (default 1) runs of every point and seed, reproducible runs only differ in
+                          wall time
+       "concurrent runs"  (default 0, one per worker) runs at a time, at most one per worker
+       "worker threads"   (default 0, one per hardware thread) size of the pool the runs share
+       "output"           (default "batch.csv") where the results table goes
+       "format"           (default "csv") "csv" or "binary"
+
+   The runs are tasks on the shared pool, each taking the next run when it finishes one, and every
+   run's islands take turns on its worker (see GA::runIslandsInline) so runs never wait on each
+   other. Runs print nothing and write no files of their own: the batch sets their "seed", "print
+   results", "print every", "checkpoint every" and "verbose".
+
+   The results table has a row per run: run, point, seed, repeat, every grid parameter, then the
+   best fitness, the evaluations used and the wall time in ms (initial population and optimisation).
+
+   csv     a header of the column names, then a line per run (grid strings quoted as in json)
+   binary  little endian, read by Example/SchwefelFunction/batch.py, grid values that are not
+           numbers are stored as their index in the grid's list
+
+           char[8]  "GATABLE\0"
+           uint32   version (1)
+           uint32   columns
+           uint64   rows
+           per column: uint32 length, then the name
+           then rows x columns float64, row by row */
+
+enum class BatchFormat { csv, binary };
+
+struct BatchRun
+{   // one run of a sweep
+    int run;
+    int point;                 // index of the grid point
+    long long seed;
+    int repeat;
+    nlohmann::json parameters; // the complete parameters of the run
+};
+
+struct BatchResult
+{
+    double bestFitness = 0;
+    long evaluations = 0;
+    double wallMs = 0;
+};
+
+struct BatchSpec
+{
+    nlohmann::json parameters;
+    std::vector<std::pair<std::string, std::vector<nlohmann::json>>> grid;
+    std::vector<long long> seeds;
+    int repeats = 1;
+    int concurrentRuns = 0;
+    int workerThreads = 0;
+    std::string output = "batch.csv";
+    BatchFormat format = BatchFormat::csv;
+
+    static BatchSpec read(ConfigReader& reader, const std::string& directory)
+    {   // directory is where relative "parameters" paths start from
+        BatchSpec b;
+        const nlohmann::json* parameters = reader.raw("parameters");
+        if(!parameters) throw ConfigError("missing parameter \"parameters\"");
+        if(parameters->is_string())
+        {
+            std::filesystem::path path = parameters->get<std::string>();
+            if(path.is_relative()) path = std::filesystem::path(directory) / path;
+            std::ifstream f(path);
+            if(!f) throw ConfigError("cannot open " + path.string());
+            b.parameters = nlohmann::json::parse(f);
+        }else b.parameters = *parameters;
+        require(b.parameters.is_object(), "\"parameters\" must be a json object or the path of one");
+
+        if(const nlohmann::json* grid = reader.raw("grid"))
+        {
+            require(grid->is_object(), "\"grid\" must map parameters to lists of values");
+            for(auto it = grid->begin(); it != grid->end(); ++it)
+            {
+                require(it->is_array() && !it->empty(), "grid parameter \"" + it.key() + "\" needs a list of values");
+                require(it.key() != "seed", "seeds are swept by \"seeds\", not the grid");
+                b.grid.push_back({it.key(), std::vector<nlohmann::json>(it->begin(), it->end())});
+            }
+        }
+
+        const nlohmann::json* seeds = reader.raw("seeds");
+        if(!seeds) b.seeds = {1};
+        else if(seeds->is_array())
+        {
+            for(const nlohmann::json& seed : *seeds)
+            {
+                require(seed.is_number_integer(), "\"seeds\" must be whole numbers");
+                b.seeds.push_back(seed.get<long long>());
+            }
+        }else if(seeds->is_object() && seeds->size() == 2 && seeds->contains("first") && seeds->contains("count")
+                 && seeds->at("first").is_number_integer() && seeds->at("count").is_number_integer())
+        {
+            for(long long k=0; k<seeds->at("count").get<long long>(); k++)
+                b.seeds.push_back(seeds->at("first").get<long long>() + k);
+        }else throw ConfigError("\"seeds\" must be a list of seeds or {\"first\": seed, \"count\": n}");
+        require(!b.seeds.empty(), "\"seeds\" must hold at least one seed");
+
+        b.repeats = reader.get<int>("repeats", 1);
+        b.concurrentRuns = reader.get<int>("concurrent runs", 0);
+        b.workerThreads = reader.get<int>("worker threads", 0);
+        b.output = reader.get<std::string>("output", "batch.csv");
+        std::string format = reader.get<std::string>("format", "csv");
+        if(format == "csv") b.format = BatchFormat::csv;
+        else if(format == "binary") b.format = BatchFormat::binary;
+        else throw ConfigError("unknown batch format \"" + format + "\" (csv or binary)");
+
+        require(b.repeats >= 1, "\"repeats\" must be at least 1");
+        require(b.concurrentRuns >= 0, "\"concurrent runs\" must not be negative");
+        require(b.workerThreads >= 0, "\"worker threads\" must not be negative");
+        return b;
+    }
+
+    int points() const
+    {
+        int n = 1;
+        for(auto& parameter : grid) n *= parameter.second.size();
+        return n;
+    }
+
+    int gridIndex(int point, int k) const
+    {   // which value of grid parameter k grid point point takes, the last parameter varies fastest
+        for(int j=grid.size()-1; j>k; j--) point /= grid[j].second.size();
+        return point % grid[k].second.size();
+    }
+
+    std::vector<BatchRun> runs() const
+    {   // every point, seed and repeat in that order
+        std::vector<BatchRun> runs;
+        for(int point=0; point<points(); point++)
+        {
+            nlohmann::json p = parameters;
+            for(int k=0; k<grid.size(); k++) p[grid[k].first] = grid[k].second[gridIndex(point, k)];
+            p["print results"] = false;
+            p["print every"] = std::numeric_limits<int>::max(); // past any "max_iterations", so no snapshots
+            p["checkpoint every"] = 0;
+            p["verbose"] = false;
+            for(long long seed : seeds)
+            {
+                p["seed"] = seed;
+                for(int repeat=0; repeat<repeats; repeat++)
+                    runs.push_back(BatchRun{static_cast<int>(runs.size()), point, seed, repeat, p});
+            }
+        }
+        return runs;
+    }
+};
+
+template <typename F>
+std::vector<BatchResult> runBatch(const std::vector<BatchRun>& runs, ThreadPool& pool, int concurrentRuns, F&& run)
+{   // run(batchRun) -> BatchResult for every run, concurrentRuns (0: one per worker) at a time on pool.
+    // The first exception a run throws stops the batch and is rethrown here
+    std::vector<BatchResult> results(runs.size());
+    std::atomic<int> next{0};
+    std::atomic<int> finished{0};
+    std::mutex errorGuard;
+    std::exception_ptr error;
+    TaskCounter running;
+    const int n = runs.size();
+    const int tasks = std::min(n, concurrentRuns > 0 ? std::min(concurrentRuns, pool.size()) : pool.size());
+    auto worker = [&]()
+    {   // take the next run until there are none left
+        for(int r=next.fetch_add(1); r<n; r=next.fetch_add(1))
+        {
+            try
+            {
+                results[r] = run(runs[r]);
+            }catch(...)
+            {
+                std::lock_guard<std::mutex> lock(errorGuard);
+                if(!error) error = std::current_exception();
+                next.store(n);
+            }
+            const int done = finished.fetch_add(1) + 1;
+            if(done * 10 / n != (done - 1) * 10 / n) THREADPRINT("--batch: " << done << " of " << n << " runs done\n")
+        }
+        running.done();
+    };
+    running.add(tasks);
+    for(int i=0; i<tasks; i++) pool.submit(worker);
+    pool.wait(running);
+    if(error) std::rethrow_exception(error);
+    return results;
+}
+
+void writeBatchTable(const std::string& path, BatchFormat format, const BatchSpec& spec,
+                     const std::vector<BatchRun>& runs, const std::vector<BatchResult>& results)
+{   // the results table, see the top of this file
+    std::vector<std::string> columns = {"run", "point", "seed", "repeat"};
+    for(auto& parameter : spec.grid) columns.push_back(parameter.first);
+    for(const char* column : {"best fitness", "evaluations", "wall ms"}) columns.push_back(column);
+
+    std::ofstream out(path, format == BatchFormat::binary ? std::ios::out|std::ios::binary|std::ios::trunc
+                                                          : std::ios::out|std::ios::trunc);
+    if(!out) throw std::runtime_error("cannot write " + path);
+    if(format == BatchFormat::csv)
+    {
+        out.precision(std::numeric_limits<float>::max_digits10);
+        for(int c=0; c<columns.size(); c++) out << (c ? "," : "") << columns[c];
+        out << '\n';
+        for(int r=0; r<runs.size(); r++)
+        {
+            const BatchRun& run = runs[r];
+            out << run.run << ',' << run.point << ',' << run.seed << ',' << run.repeat;
+            for(int k=0; k<spec.grid.size(); k++) out << ',' << spec.grid[k].second[spec.gridIndex(run.point, k)].dump();
+            out << ',' << results[r].bestFitness << ',' << results[r].evaluations << ',' << results[r].wallMs << '\n';
+        }
+    }else
+    {
+        auto put = [&](auto value){ out.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+        out.write("GATABLE\0", 8);
+        put(static_cast<uint32_t>(1));
+        put(static_cast<uint32_t>(columns.size()));
+        put(static_cast<uint64_t>(runs.size()));
+        for(const std::string& column : columns)
+        {
+            put(static_cast<uint32_t>(column.size()));
+            out.write(column.data(), column.size());
+        }
+        for(int r=0; r<runs.size(); r++)
+        {
+            const BatchRun& run = runs[r];
+            put(static_cast<double>(run.run));
+            put(static_cast<double>(run.point));
+            put(static_cast<double>(run.seed));
+            put(static_cast<double>(run.repeat));
+            for(int k=0; k<spec.grid.size(); k++)
+            {
+                const int index = spec.gridIndex(run.point, k);
+                const nlohmann::json& value = spec.grid[k].second[index];
+                put(value.is_number() ? value.get<double>() : static_cast<double>(index));
+            }
+            put(results[r].bestFitness);
+            put(static_cast<double>(results[r].evaluations));
+            put(results[r].wallMs);
+        }
+    }
+    if(!out) throw std::runtime_error("cannot write " + path);
+}
+
+#endif // INCLUDE_GA_BATCH
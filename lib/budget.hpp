@@ -0,0 +1,173 @@
+#ifndef INCLUDE_GA_BUDGET
+#define INCLUDE_GA_BUDGET
+
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <algorithm>
+
+/* The evaluation budget ("max_eval") of a run, shared by every island.
+
+   Islands never touch the shared counter per evaluation. Each island holds an EvaluationQuota that
+   reserves evaluations from the budget in batches and hands them out locally, counting what its
+   island actually used in its own (cache-line sized) shard. A reservation never goes past the limit,
+   and an island that cannot be granted a whole generation is granted what is left, so the run stops
+   exactly at the budget: once every island has run out, the shards add up to the limit.
+
+   Which island gets how much of a shared budget depends on timing, so reproducible runs instead
+   allot each island a fixed share up front (EvaluationQuota::allot) and never top it up.
+
+   A budget can also be leased (setLease): once its limit is reached the lease is asked for more, and
+   the limit raised by what it grants, until it grants nothing. A cluster worker leases its budget
+   from the coordinator that holds the run's "max_eval" (see cluster.hpp). */
+
+class EvaluationBudget
+{
+private:
+    std::atomic<long> _limit;     // < 0 means unlimited
+    std::atomic<long> _reserved;  // handed out to quotas so far
+    std::function<long(long)> _lease; // asked for more once the limit is reached, see setLease()
+    std::atomic<bool> _leasing{false}; // the lease may still grant more
+    std::mutex _leaseGuard;
+
+    bool extend(long n, long limit)
+    {   // raise the limit (last seen as limit) through the lease, one thread at a time. False once the
+        // lease has nothing left
+        std::lock_guard<std::mutex> lock(_leaseGuard);
+        if(_limit.load() != limit) return true; // another thread just did
+        if(!_leasing.load()) return false;
+        const long granted = _lease(n);
+        if(granted <= 0)
+        {
+            _leasing = false;
+            return false;
+        }
+        _limit.fetch_add(granted);
+        return true;
+    }
+
+public:
+    explicit EvaluationBudget(long limit = -1) : _limit(limit), _reserved(0) {}
+
+    void reset(long limit)
+    {   // only while no island is running
+        _limit = limit;
+        _reserved.store(0);
+    }
+
+    void setLease(std::function<long(long)> lease)
+    {   // lease(n) grants up to (at least) n more evaluations when the limit is reached, only while no
+        // island is running
+        _lease = std::move(lease);
+        _leasing = static_cast<bool>(_lease);
+    }
+
+    long limit() const { return _limit.load(); }
+    bool unlimited() const { return _limit.load() < 0; }
+
+    long remaining() const
+    {   // while the lease may grant more there is always something left
+        if(unlimited()) return 1;
+        const long left = _limit.load() - _reserved.load(std::memory_order_relaxed);
+        return left <= 0 && _leasing.load() ? 1 : left;
+    }
+
+    long reserve(long n)
+    {   // reserve up to n evaluations, returns how many were granted (0 once the budget is spent)
+        if(unlimited()) return n;
+        long reserved = _reserved.load(std::memory_order_relaxed);
+        while(true)
+        {
+            const long limit = _limit.load();
+            const long granted = std::min(n, limit - reserved);
+            if(granted <= 0)
+            {
+                if(!extend(n, limit)) return 0;
+                reserved = _reserved.load(std::memory_order_relaxed);
+            }else if(_reserved.compare_exchange_weak(reserved, reserved + granted, std::memory_order_relaxed)) return granted;
+        }
+    }
+
+    void unreserve(long n)
+    {   // give back evaluations reserved but never used
+        if(!unlimited()) _reserved.fetch_sub(n, std::memory_order_relaxed);
+    }
+
+    template <typename Archive>
+    void checkpoint(Archive& archive)
+    {   // only while no island is running, see checkpoint.hpp
+        long limit = _limit.load();
+        long reserved = _reserved.load();
+        archive.io(limit);
+        archive.io(reserved);
+        if(!Archive::saving)
+        {
+            _limit.store(limit);
+            _reserved.store(reserved);
+        }
+    }
+};
+
+class alignas(64) EvaluationQuota
+{   // one island's share of the budget, only ever used by one thread at a time
+private:
+    EvaluationBudget* _budget;
+    long _batch;  // evaluations reserved from the budget at a time
+    long _local;  // reserved but not yet used
+    long _used;
+    bool _fixed;  // allotted up front, no further reservations
+
+public:
+    explicit EvaluationQuota(EvaluationBudget* budget = nullptr, long batch = 256)
+        : _budget(budget), _batch(batch), _local(0), _used(0), _fixed(false) {}
+
+    void allot(long n)
+    {   // reserve n evaluations now and never reserve more, the island gets exactly this share
+        if(_budget == nullptr) return;
+        _local += _budget->reserve(n);
+        _fixed = true;
+    }
+
+    long acquire(long n)
+    {   // permission to evaluate up to n solutions, returns how many may be evaluated
+        if(_budget == nullptr)
+        {
+            _used += n;
+            return n;
+        }
+        while(!_fixed && _local < n)
+        {
+            long granted = _budget->reserve(std::max(_batch, n - _local));
+            if(granted == 0) break;
+            _local += granted;
+        }
+        long granted = std::min(n, _local);
+        _local -= granted;
+        _used += granted;
+        return granted;
+    }
+
+    bool exhausted() const
+    {   // nothing left here nor in the budget
+        return _budget != nullptr && _local == 0 && (_fixed || _budget->remaining() <= 0);
+    }
+
+    void release()
+    {   // return the unused part of the reservation, eg. when the island stops for another reason
+        if(_budget != nullptr) _budget->unreserve(_local);
+        _local = 0;
+    }
+
+    long used() const { return _used; }
+
+    template <typename Archive>
+    void checkpoint(Archive& archive)
+    {   // everything but the budget it draws on, see checkpoint.hpp
+        archive.io(_batch);
+        archive.io(_local);
+        archive.io(_used);
+        archive.io(_fixed);
+    }
+};
+
+#endif // INCLUDE_GA_BUDGET
@@ -0,0 +1,280 @@
+#ifndef INCLUDE_GA_CACHE
+#define INCLUDE_GA_CACHE
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include "config.hpp"
+#include "profile.hpp"
+
+/* A fitness cache in front of the problem's objective ("cache capacity" > 0), so solutions the run
+   has already evaluated are not evaluated (nor charged to "max_eval") again: children that collapse
+   onto a parent, migrants bred back into islands that already had them.
+
+   Solutions are keyed by their coordinates quantised to a grid of "cache resolution" (0: the exact
+   float bits), so a hit returns the fitness of a solution in the same grid cell. The cache is split
+   into shards by key hash, each behind its own mutex and holding a fixed share of the capacity in
+   flat arrays (linear probing, entries of a fixed size), so neither lookups nor inserts allocate.
+   A full shard evicts by "cache eviction":
+
+   clock  (default) a reference bit per entry, set on every hit, and a hand sweeping the entries that
+          clears set bits and evicts the first entry found clear; about LRU at one byte per entry
+   lru    the least recently inserted or hit entry, from a doubly linked list through the entries
+
+   Free-running islands share one cache. In a reproducible run every island has its own (of an equal
+   share of the capacity), looked up and filled only by the island's own generations in their order,
+   so a seed gives the same hits whatever the timing; the island caches are part of a checkpoint. */
+
+struct CacheStats
+{
+    long hits = 0;
+    long misses = 0;
+    long evictions = 0;
+
+    CacheStats& operator+=(const CacheStats& other)
+    {
+        hits += other.hits;
+        misses += other.misses;
+        evictions += other.evictions;
+        return *this;
+    }
+
+    double hitRate() const { return hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0; }
+};
+
+class FitnessCache
+{
+private:
+    struct alignas(64) Shard
+    {
+        std::mutex guard;
+        int capacity = 0;
+        int used = 0;                 // entries filled, entry i < used is live
+        std::vector<int32_t> keys;    // entry i's quantised coordinates at i*dimension
+        std::vector<uint64_t> hashes;
+        std::vector<float> fitness;
+        std::vector<int32_t> table;   // entry index or -1, open addressing with linear probing
+        std::vector<uint8_t> referenced; // clock
+        int hand = 0;
+        std::vector<int32_t> newer;   // lru, towards the most recent entry (-1 at the head)
+        std::vector<int32_t> older;
+        int head = -1;                // lru, most recent
+        int tail = -1;                // lru, least recent
+        CacheStats stats;
+    };
+
+    int _dimension;
+    float _resolution;
+    CacheEviction _eviction;
+    int _shardBits;
+    std::vector<std::unique_ptr<Shard>> _shards;
+
+    template <typename S>
+    int32_t quantise(const S& s, int d) const
+    {
+        const float x = s.getX(d);
+        if(_resolution <= 0)
+        {
+            int32_t bits;
+            std::memcpy(&bits, &x, sizeof(bits));
+            return bits;
+        }
+        const double q = std::floor(x / static_cast<double>(_resolution) + 0.5);
+        return static_cast<int32_t>(std::min(std::max(q, -2147483648.0), 2147483647.0));
+    }
+
+    template <typename S>
+    uint64_t hash(const S& s) const
+    {
+        uint64_t h = 0x9E3779B97F4A7C15ull;
+        for(int d=0; d<_dimension; d++)
+        {
+            h ^= static_cast<uint32_t>(quantise(s, d));
+            h *= 0xFF51AFD7ED558CCDull;
+            h ^= h >> 32;
+        }
+        return h;
+    }
+
+    Shard& shardOf(uint64_t h) const { return *_shards[_shardBits ? h >> (64 - _shardBits) : 0]; }
+
+    template <typename S>
+    int find(const Shard& shard, const S& s, uint64_t h) const
+    {   // the entry holding s's key, or -1
+        const size_t mask = shard.table.size() - 1;
+        for(size_t i=h&mask; shard.table[i]>=0; i=(i+1)&mask)
+        {
+            const int e = shard.table[i];
+            if(shard.hashes[e] != h) continue;
+            const int32_t* key = &shard.keys[static_cast<size_t>(e) * _dimension];
+            int d = 0;
+            while(d < _dimension && key[d] == quantise(s, d)) d++;
+            if(d == _dimension) return e;
+        }
+        return -1;
+    }
+
+    void unlink(Shard& shard, int e)
+    {   // lru
+        if(shard.newer[e] >= 0) shard.older[shard.newer[e]] = shard.older[e];
+        else shard.head = shard.older[e];
+        if(shard.older[e] >= 0) shard.newer[shard.older[e]] = shard.newer[e];
+        else shard.tail = shard.newer[e];
+    }
+
+    void touch(Shard& shard, int e, bool linked)
+    {   // e was just used
+        if(_eviction == CacheEviction::clock)
+        {
+            shard.referenced[e] = 1;
+            return;
+        }
+        if(linked) unlink(shard, e);
+        shard.newer[e] = -1;
+        shard.older[e] = shard.head;
+        if(shard.head >= 0) shard.newer[shard.head] = e;
+        shard.head = e;
+        if(shard.tail < 0) shard.tail = e;
+    }
+
+    void removeFromTable(Shard& shard, int e)
+    {   // backward shift deletion, so probes never need tombstones
+        const size_t mask = shard.table.size() - 1;
+        size_t i = shard.hashes[e] & mask;
+        while(shard.table[i] != e) i = (i+1) & mask;
+        for(size_t j=(i+1)&mask; shard.table[j]>=0; j=(j+1)&mask)
+        {
+            const size_t home = shard.hashes[shard.table[j]] & mask;
+            const bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+            if(stays) continue;
+            shard.table[i] = shard.table[j];
+            i = j;
+        }
+        shard.table[i] = -1;
+    }
+
+    int evict(Shard& shard)
+    {   // free an entry of a full shard
+        int e;
+        if(_eviction == CacheEviction::clock)
+        {
+            while(shard.referenced[shard.hand])
+            {
+                shard.referenced[shard.hand] = 0;
+                shard.hand = (shard.hand + 1) % shard.capacity;
+            }
+            e = shard.hand;
+            shard.hand = (shard.hand + 1) % shard.capacity;
+        }else
+        {
+            e = shard.tail;
+            unlink(shard, e);
+        }
+        removeFromTable(shard, e);
+        shard.stats.evictions += 1;
+        return e;
+    }
+
+public:
+    FitnessCache(long capacity, int dimension, float resolution, CacheEviction eviction, int shards)
+        : _dimension(dimension), _resolution(resolution), _eviction(eviction), _shardBits(0)
+    {   // shards is rounded up to a power of two, each holds an equal share of capacity
+        while((1 << _shardBits) < shards) _shardBits++;
+        const int n = 1 << _shardBits;
+        for(int k=0; k<n; k++)
+        {
+            auto shard = std::make_unique<Shard>();
+            shard->capacity = std::max<long>(1, (capacity + n - 1) / n);
+            shard->keys.resize(static_cast<size_t>(shard->capacity) * dimension);
+            shard->hashes.resize(shard->capacity);
+            shard->fitness.resize(shard->capacity);
+            size_t tableSize = 1;
+            while(tableSize < 2 * static_cast<size_t>(shard->capacity)) tableSize *= 2; // at most half full
+            shard->table.assign(tableSize, -1);
+            if(eviction == CacheEviction::clock) shard->referenced.assign(shard->capacity, 0);
+            else
+            {
+                shard->newer.assign(shard->capacity, -1);
+                shard->older.assign(shard->capacity, -1);
+            }
+            _shards.push_back(std::move(shard));
+        }
+    }
+
+    template <typename S>
+    bool lookup(const S& s, float& fitness)
+    {   // the cached fitness of s's key, if there is one
+        const uint64_t h = hash(s);
+        Shard& shard = shardOf(h);
+        std::lock_guard<std::mutex> lock(shard.guard);
+        const int e = find(shard, s, h);
+        if(e < 0)
+        {
+            shard.stats.misses += 1;
+            profile::count(profile::Counter::cacheMisses);
+            return false;
+        }
+        touch(shard, e, true);
+        fitness = shard.fitness[e];
+        shard.stats.hits += 1;
+        profile::count(profile::Counter::cacheHits);
+        return true;
+    }
+
+    template <typename S>
+    void insert(const S& s, float fitness)
+    {   // cache s's fitness under its key, evicting an entry if the shard is full
+        const uint64_t h = hash(s);
+        Shard& shard = shardOf(h);
+        std::lock_guard<std::mutex> lock(shard.guard);
+        int e = find(shard, s, h);
+        if(e >= 0)
+        {
+            shard.fitness[e] = fitness;
+            touch(shard, e, true);
+            return;
+        }
+        e = shard.used < shard.capacity ? shard.used++ : evict(shard);
+        for(int d=0; d<_dimension; d++) shard.keys[static_cast<size_t>(e) * _dimension + d] = quantise(s, d);
+        shard.hashes[e] = h;
+        shard.fitness[e] = fitness;
+        const size_t mask = shard.table.size() - 1;
+        size_t i = h & mask;
+        while(shard.table[i] >= 0) i = (i+1) & mask;
+        shard.table[i] = e;
+        touch(shard, e, false);
+    }
+
+    CacheStats stats() const
+    {   // only meaningful while no island is using the cache
+        CacheStats total;
+        for(auto& shard : _shards) total += shard->stats;
+        return total;
+    }
+
+    template <typename Archive>
+    void checkpoint(Archive& archive)
+    {   // every shard in full, only while no island is using the cache, see checkpoint.hpp
+        for(auto& shard : _shards)
+        {
+            archive.io(shard->used);
+            archive.io(shard->hand);
+            archive.io(shard->head);
+            archive.io(shard->tail);
+            archive.io(shard->stats);
+            archive.io(shard->keys.data(), shard->keys.size());
+            archive.io(shard->hashes.data(), shard->hashes.size());
+            archive.io(shard->fitness.data(), shard->fitness.size());
+            archive.io(shard->table.data(), shard->table.size());
+            archive.io(shard->referenced.data(), shard->referenced.size());
+            archive.io(shard->newer.data(), shard->newer.size());
+            archive.io(shard->older.data(), shard->older.size());
+        }
+    }
+};
+
+#endif // INCLUDE_GA_CACHE
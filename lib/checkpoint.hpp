@@ -0,0 +1,315 @@
+#ifndef INCLUDE_GA_CHECKPOINT
+#define INCLUDE_GA_CHECKPOINT
+
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Checkpoints of a whole run in a memory-mapped file, so a run that dies can be resumed.
+
+   The file holds a header page and two slots, each large enough for the complete state. A
+   checkpoint is written into the slot not holding the latest one, then a background thread syncs
+   the slot to disk, checksums it and only then publishes it in the header with a higher sequence
+   number; resuming takes the newest slot whose checksum matches, so a crash at any point leaves the
+   previous checkpoint usable. While the thread is still syncing a slot no new checkpoint is started.
+
+   Writes are incremental: CheckpointSaver compares every value with what the slot already holds
+   (the state from two checkpoints ago) and only stores those that changed, so only the pages that
+   changed are dirtied and synced. A population that replaces a few members per generation costs
+   little more than a read of the slot.
+
+   Classes take part through one function serving all three archives,
+
+       template <typename Archive> void checkpoint(Archive& archive) { archive.io(_member); ... }
+
+   CheckpointMeasurer counts the bytes (the slot size), CheckpointSaver writes, CheckpointLoader
+   reads. The layout must only depend on the run's parameters, so containers store their full
+   capacity. The file is native endian and only read back on the machine type that wrote it.
+
+   header   char[8] "GACKPT\0\0", uint32 version, uint32 pageSize, uint64 slotBytes, uint64 payloadBytes,
+            then per slot: uint64 sequence (0: never written), uint64 checksum */
+
+class CheckpointError : public std::runtime_error
+{
+public:
+    explicit CheckpointError(const std::string& what) : std::runtime_error(what) {}
+};
+
+class CheckpointMeasurer
+{
+private:
+    size_t _bytes = 0;
+
+public:
+    static constexpr bool saving = true; // state is read from the objects, as when saving
+
+    template <typename V>
+    void io(const V&) { _bytes += sizeof(V); }
+
+    template <typename V>
+    void io(const V*, size_t n) { _bytes += n * sizeof(V); }
+
+    size_t bytes() const { return _bytes; }
+};
+
+class CheckpointSaver
+{
+private:
+    char* _p;
+    char* _end;
+
+public:
+    static constexpr bool saving = true;
+
+    CheckpointSaver(char* begin, size_t bytes) : _p(begin), _end(begin + bytes) {}
+
+    template <typename V>
+    void io(const V& value)
+    {   // store value unless the slot already holds it
+        static_assert(std::is_trivially_copyable<V>::value, "checkpoints store plain values");
+        if(_p + sizeof(V) > _end) throw CheckpointError("checkpoint state is larger than its slot");
+        if(std::memcmp(_p, &value, sizeof(V)) != 0) std::memcpy(_p, &value, sizeof(V));
+        _p += sizeof(V);
+    }
+
+    template <typename V>
+    void io(const V* values, size_t n)
+    {   // n values in one go
+        static_assert(std::is_trivially_copyable<V>::value, "checkpoints store plain values");
+        const size_t bytes = n * sizeof(V);
+        if(_p + bytes > _end) throw CheckpointError("checkpoint state is larger than its slot");
+        if(std::memcmp(_p, values, bytes) != 0) std::memcpy(_p, values, bytes);
+        _p += bytes;
+    }
+};
+
+class CheckpointLoader
+{
+private:
+    const char* _p;
+    const char* _end;
+
+public:
+    static constexpr bool saving = false;
+
+    CheckpointLoader(const char* begin, size_t bytes) : _p(begin), _end(begin + bytes) {}
+
+    template <typename V>
+    void io(V& value)
+    {
+        static_assert(std::is_trivially_copyable<V>::value, "checkpoints store plain values");
+        if(_p + sizeof(V) > _end) throw CheckpointError("checkpoint is shorter than the state it should hold");
+        std::memcpy(&value, _p, sizeof(V));
+        _p += sizeof(V);
+    }
+
+    template <typename V>
+    void io(V* values, size_t n)
+    {
+        static_assert(std::is_trivially_copyable<V>::value, "checkpoints store plain values");
+        const size_t bytes = n * sizeof(V);
+        if(_p + bytes > _end) throw CheckpointError("checkpoint is shorter than the state it should hold");
+        std::memcpy(values, _p, bytes);
+        _p += bytes;
+    }
+};
+
+template <typename Archive, typename S>
+void checkpointSolution(Archive& archive, S&& solution, int dimension)
+{   // a solution (or SoA member proxy) as dimension coordinates and its objective
+    for(int d=0; d<dimension; d++)
+    {
+        float x = solution.getX(d);
+        archive.io(x);
+        if(!Archive::saving) solution.setX(d, x);
+    }
+    float f = solution.getEval();
+    archive.io(f);
+    if(!Archive::saving) solution.setEval(f);
+}
+
+class CheckpointFile
+{
+private:
+    static constexpr char magic[8] = {'G', 'A', 'C', 'K', 'P', 'T', 0, 0};
+    static constexpr uint32_t version = 1;
+
+    struct SlotHeader
+    {
+        uint64_t sequence;
+        uint64_t checksum;
+    };
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t pageSize;
+        uint64_t slotBytes;
+        uint64_t payloadBytes;
+        SlotHeader slots[2];
+    };
+
+    int _fd = -1;
+    char* _map = nullptr;
+    size_t _mapBytes = 0;
+    size_t _pageSize = 4096;
+
+    // the flusher thread, publishing one slot at a time
+    std::thread _flusher;
+    std::mutex _guard;
+    std::condition_variable _wake;
+    int _flushing = -1;   // slot being synced, -1 when idle
+    uint64_t _flushSequence = 0;
+    bool _stop = false;
+
+    Header& header() { return *reinterpret_cast<Header*>(_map); }
+    char* slot(int s) { return _map + _pageSize + s * header().slotBytes; }
+
+    static uint64_t checksum(const char* data, size_t bytes)
+    {   // FNV-1a over 8 byte words, then the tail
+        uint64_t h = 1469598103934665603ull;
+        size_t i = 0;
+        for(; i+8<=bytes; i+=8)
+        {
+            uint64_t w;
+            std::memcpy(&w, data + i, 8);
+            h = (h ^ w) * 1099511628211ull;
+        }
+        for(; i<bytes; i++) h = (h ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+        return h;
+    }
+
+    void flushLoop()
+    {
+        std::unique_lock<std::mutex> lock(_guard);
+        while(true)
+        {
+            _wake.wait(lock, [&]{ return _stop || _flushing >= 0; });
+            if(_flushing < 0) return; // stopping with nothing to flush
+            const int s = _flushing;
+            const uint64_t sequence = _flushSequence;
+            lock.unlock();
+            const uint64_t sum = checksum(slot(s), header().payloadBytes);
+            msync(slot(s), header().slotBytes, MS_SYNC); // the data reaches the disk before the header names it
+            header().slots[s].checksum = sum;
+            header().slots[s].sequence = sequence;
+            msync(_map, _pageSize, MS_SYNC);
+            lock.lock();
+            _flushing = -1;
+            _wake.notify_all();
+        }
+    }
+
+    void map(const std::string& path, size_t bytes, bool create)
+    {
+        _fd = ::open(path.c_str(), create ? O_RDWR|O_CREAT : O_RDWR, 0644);
+        if(_fd < 0) throw CheckpointError("cannot open checkpoint file " + path);
+        if(create && ftruncate(_fd, bytes) != 0) throw CheckpointError("cannot size checkpoint file " + path);
+        if(!create)
+        {
+            struct stat st;
+            if(fstat(_fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Header)))
+                throw CheckpointError(path + " is not a checkpoint");
+            bytes = st.st_size;
+        }
+        void* p = mmap(nullptr, bytes, PROT_READ|PROT_WRITE, MAP_SHARED, _fd, 0);
+        if(p == MAP_FAILED) throw CheckpointError("cannot map checkpoint file " + path);
+        _map = static_cast<char*>(p);
+        _mapBytes = bytes;
+    }
+
+public:
+    CheckpointFile() : _pageSize(sysconf(_SC_PAGESIZE)) {}
+    CheckpointFile(const CheckpointFile&) = delete;
+    CheckpointFile& operator=(const CheckpointFile&) = delete;
+
+    ~CheckpointFile()
+    {
+        if(_flusher.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(_guard);
+                _stop = true;
+            }
+            _wake.notify_all();
+            _flusher.join();
+        }
+        if(_map) munmap(_map, _mapBytes);
+        if(_fd >= 0) ::close(_fd);
+    }
+
+    void create(const std::string& path, size_t payloadBytes)
+    {   // a fresh file with room for two checkpoints of payloadBytes, replacing any old one
+        const size_t slotBytes = (payloadBytes + _pageSize - 1) / _pageSize * _pageSize;
+        ::unlink(path.c_str());
+        map(path, _pageSize + 2 * slotBytes, true);
+        Header& h = header();
+        std::memcpy(h.magic, magic, sizeof(magic));
+        h.version = version;
+        h.pageSize = _pageSize;
+        h.slotBytes = slotBytes;
+        h.payloadBytes = payloadBytes;
+        h.slots[0] = h.slots[1] = SlotHeader{0, 0};
+        msync(_map, _pageSize, MS_SYNC);
+        _flusher = std::thread(&CheckpointFile::flushLoop, this);
+    }
+
+    const char* open(const std::string& path, size_t& payloadBytes, uint64_t& sequence)
+    {   // the newest complete checkpoint in path, valid until the next commit
+        map(path, 0, false);
+        Header& h = header();
+        if(std::memcmp(h.magic, magic, sizeof(magic)) != 0) throw CheckpointError(path + " is not a checkpoint");
+        if(h.version != version) throw CheckpointError(path + " is a checkpoint of an unsupported version");
+        if(h.pageSize != _pageSize || _pageSize + 2 * h.slotBytes > _mapBytes)
+            throw CheckpointError(path + " is truncated or was written on another machine type");
+        int best = -1;
+        for(int s=0; s<2; s++)
+        {
+            if(h.slots[s].sequence == 0 || checksum(slot(s), h.payloadBytes) != h.slots[s].checksum) continue;
+            if(best < 0 || h.slots[s].sequence > h.slots[best].sequence) best = s;
+        }
+        if(best < 0) throw CheckpointError(path + " holds no complete checkpoint");
+        payloadBytes = h.payloadBytes;
+        sequence = h.slots[best].sequence;
+        _flusher = std::thread(&CheckpointFile::flushLoop, this); // later checkpoints go to the same file
+        return slot(best);
+    }
+
+    size_t payloadBytes() { return header().payloadBytes; }
+
+    char* beginWrite(int& s)
+    {   // the slot to write the next checkpoint into, or nullptr while the last one is still being synced
+        std::lock_guard<std::mutex> lock(_guard);
+        if(_flushing >= 0) return nullptr;
+        Header& h = header();
+        s = h.slots[0].sequence <= h.slots[1].sequence ? 0 : 1; // never the latest
+        return slot(s);
+    }
+
+    void commit(int s)
+    {   // publish slot s in the background, once it is safely on disk
+        std::lock_guard<std::mutex> lock(_guard);
+        _flushSequence = std::max(header().slots[0].sequence, header().slots[1].sequence) + 1;
+        _flushing = s;
+        _wake.notify_all();
+    }
+
+    void wait()
+    {   // until the last commit is published
+        std::unique_lock<std::mutex> lock(_guard);
+        _wake.wait(lock, [&]{ return _flushing < 0; });
+    }
+};
+
+#endif // INCLUDE_GA_CHECKPOINT
@@ -0,0 +1,649 @@
+#ifndef INCLUDE_GA_CLUSTER
+#define INCLUDE_GA_CLUSTER
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "config.hpp"
+#include "migration.hpp"
+#include "random.hpp"
+#include "utils.hpp"
+
+/* Islands in several processes on one host, eg. one per NUMA node or container: a coordinator and
+   "processes" workers, each worker a whole GA (its own "population size" on its own "number of
+   Threads" islands) connected to the coordinator over a Unix socket at "coordinator socket".
+
+       GA_run --cluster parameters.json       the coordinator, starting the workers as child processes
+       GA_run --coordinator parameters.json   the coordinator alone, and
+       GA_run --worker parameters.json        a worker, each started however the host runs them
+
+   The coordinator holds the run's "max_eval": every worker's budget is leased from it in batches
+   (EvaluationBudget::setLease), and what a worker leased but did not use is given back when it
+   finishes, so the workers together stop at the budget. It relays migrants between the workers over
+   the "migration topology" of the processes: whenever an island migrates it also sends its migrants
+   to the neighbouring processes and takes in (up to "migrants" of) what they sent, replacing its
+   worst. Workers report their best as it improves and the coordinator prints the best of the run.
+
+   Which migrants arrive when depends on timing, so cluster runs need "reproducible": false. Worker
+   r runs from a seed derived from the coordinator's "seed" and r, and writes populationEnd.r.txt.
+
+   Messages are framed as uint32 type, uint32 payload bytes, payload, native endian (both ends are
+   on the same host). A solution travels compactly as float32 objective then float32 x[dimension].
+
+       hello     worker -> coordinator  int32 dimension
+       welcome   coordinator -> worker  int32 rank, int32 processes, uint64 seed
+       lease     worker -> coordinator  int64 evaluations wanted
+       grant     coordinator -> worker  int64 evaluations granted (0: the budget is spent)
+       migrant   both ways              a solution
+       best      worker -> coordinator  a solution, the worker's best so far
+       done      worker -> coordinator  int64 evaluations used, then the worker's best solution */
+
+class ClusterError : public std::runtime_error
+{
+public:
+    explicit ClusterError(const std::string& what) : std::runtime_error(what) {}
+};
+
+namespace cluster
+{
+    enum class Message : uint32_t { hello, welcome, lease, grant, migrant, best, done };
+
+    struct Welcome
+    {
+        int32_t rank;
+        int32_t processes;
+        uint64_t seed;
+    };
+
+    constexpr long leaseSize = 1024; // evaluations a worker leases at least at a time
+
+    inline uint64_t workerSeed(uint64_t seed, int rank)
+    {   // worker 0 runs from the run's seed, the others from seeds mixed out of it (splitmix64), below 2^48
+        if(rank == 0) return seed;
+        uint64_t z = seed + 0x9E3779B97F4A7C15ull * rank;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return (z ^ (z >> 31)) & ((1ull << 48) - 1);
+    }
+
+    template <typename S>
+    void pack(const S& s, int dimension, float* out)
+    {   // a solution (or SoA member) as its objective then its coordinates
+        out[0] = s.getEval();
+        for(int d=0; d<dimension; d++) out[1+d] = s.getX(d);
+    }
+
+    template <typename S>
+    void unpack(const float* in, int dimension, S& s)
+    {
+        s.setEval(in[0]);
+        for(int d=0; d<dimension; d++) s.setX(d, in[1+d]);
+    }
+
+    class Connection
+    {   // framed messages over a connected Unix socket, callers serialise their sends
+    private:
+        int _fd = -1;
+
+        void writeAll(const void* data, size_t bytes)
+        {   // MSG_NOSIGNAL: a peer that went away is an error here, not a SIGPIPE
+            const char* p = static_cast<const char*>(data);
+            while(bytes > 0)
+            {
+                ssize_t n = ::send(_fd, p, bytes, MSG_NOSIGNAL);
+                if(n < 0 && errno == EINTR) continue;
+                if(n <= 0) throw ClusterError(std::string("cannot send to the cluster: ") + std::strerror(errno));
+                p += n;
+                bytes -= n;
+            }
+        }
+
+        bool readAll(void* data, size_t bytes)
+        {   // false if the peer closed before the first byte
+            char* p = static_cast<char*>(data);
+            const size_t total = bytes;
+            while(bytes > 0)
+            {
+                ssize_t n = recv(_fd, p, bytes, 0);
+                if(n < 0 && errno == EINTR) continue;
+                if(n == 0 && bytes == total) return false;
+                if(n <= 0) throw ClusterError("the cluster connection broke off mid message");
+                p += n;
+                bytes -= n;
+            }
+            return true;
+        }
+
+    public:
+        explicit Connection(int fd = -1) : _fd(fd) {}
+
+        Connection(Connection&& other) : _fd(other._fd) { other._fd = -1; }
+
+        Connection& operator=(Connection&& other)
+        {
+            std::swap(_fd, other._fd);
+            return *this;
+        }
+
+        ~Connection() { close(); }
+
+        int fd() const { return _fd; }
+
+        void close()
+        {
+            if(_fd >= 0) ::close(_fd);
+            _fd = -1;
+        }
+
+        void shutdown()
+        {   // wakes a thread blocked receiving, the descriptor stays open until close()
+            if(_fd >= 0) ::shutdown(_fd, SHUT_RDWR);
+        }
+
+        void send(Message type, const void* payload = nullptr, uint32_t bytes = 0)
+        {
+            const uint32_t header[2] = {static_cast<uint32_t>(type), bytes};
+            writeAll(header, sizeof(header));
+            if(bytes > 0) writeAll(payload, bytes);
+        }
+
+        bool receive(Message& type, std::vector<char>& payload)
+        {   // the next message, false once the peer closed the connection
+            uint32_t header[2];
+            if(!readAll(header, sizeof(header))) return false;
+            type = static_cast<Message>(header[0]);
+            payload.resize(header[1]);
+            if(header[1] > 0 && !readAll(payload.data(), header[1]))
+                throw ClusterError("the cluster connection broke off mid message");
+            return true;
+        }
+    };
+
+    inline sockaddr_un socketAddress(const std::string& path)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if(path.size() >= sizeof(address.sun_path)) throw ClusterError("\"coordinator socket\" path is too long: " + path);
+        std::strcpy(address.sun_path, path.c_str());
+        return address;
+    }
+
+    inline int listenOn(const std::string& path)
+    {   // replaces whatever socket a previous run left at path
+        sockaddr_un address = socketAddress(path);
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if(fd < 0) throw ClusterError(std::string("cannot create the coordinator socket: ") + std::strerror(errno));
+        unlink(path.c_str());
+        if(bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, 64) != 0)
+        {
+            const int error = errno;
+            ::close(fd);
+            throw ClusterError("cannot listen on " + path + ": " + std::strerror(error));
+        }
+        return fd;
+    }
+
+    inline int connectTo(const std::string& path, double seconds)
+    {   // retries until the coordinator listens, for up to seconds
+        sockaddr_un address = socketAddress(path);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+        while(true)
+        {
+            int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if(fd < 0) throw ClusterError(std::string("cannot create a socket: ") + std::strerror(errno));
+            if(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) return fd;
+            const int error = errno;
+            ::close(fd);
+            if(std::chrono::steady_clock::now() >= deadline)
+                throw ClusterError("cannot reach the coordinator at " + path + ": " + std::strerror(error));
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+} // namespace cluster
+
+struct ClusterStats
+{
+    long sent = 0;      // migrants sent to other processes
+    long received = 0;  // migrants from other processes taken into an island
+    long dropped = 0;   // migrants from other processes dropped on a full inbox
+};
+
+class ClusterWorker
+{   // a worker's end of the cluster: leases evaluations, relays migrants and reports its best. A thread
+    // of its own receives, so migrants keep arriving while the islands run
+private:
+    cluster::Connection _connection;
+    int _dimension;
+    int _rank = 0;
+    int _processes = 1;
+    uint64_t _seed = 0;
+    std::mutex _sendGuard;      // islands send from several threads
+    std::vector<float> _packed; // guarded by _sendGuard
+    float _bestReported = std::numeric_limits<float>::max();
+    std::mutex _guard;          // what the receiving thread shares
+    std::condition_variable _answered;
+    long _grant = -1;           // the answer to the pending lease, -1 while waiting
+    bool _closed = false;       // the coordinator hung up
+    std::vector<float> _inbox;  // ring of migrants from other processes
+    int _inboxCapacity;
+    int _inboxHead = 0;
+    int _inboxCount = 0;
+    ClusterStats _stats;
+    long _leased = 0;
+    std::thread _receiver;
+
+    bool post(cluster::Message type, const void* payload, uint32_t bytes)
+    {   // under _sendGuard, false once the coordinator is gone
+        try
+        {
+            _connection.send(type, payload, bytes);
+            return true;
+        }catch(const ClusterError&)
+        {
+            std::lock_guard<std::mutex> lock(_guard);
+            _closed = true;
+            _answered.notify_all();
+            return false;
+        }
+    }
+
+    void receiveLoop()
+    {
+        const size_t solution = sizeof(float) * (_dimension + 1);
+        cluster::Message type;
+        std::vector<char> payload;
+        while(true)
+        {
+            bool open;
+            try
+            {
+                open = _connection.receive(type, payload);
+            }catch(const ClusterError&)
+            {
+                open = false;
+            }
+            std::lock_guard<std::mutex> lock(_guard);
+            if(!open)
+            {
+                _closed = true;
+                _answered.notify_all();
+                return;
+            }
+            if(type == cluster::Message::grant && payload.size() == sizeof(int64_t))
+            {
+                int64_t granted;
+                std::memcpy(&granted, payload.data(), sizeof(granted));
+                _grant = granted;
+                _answered.notify_all();
+            }else if(type == cluster::Message::migrant && payload.size() == solution)
+            {   // a full inbox drops its oldest migrant
+                if(_inboxCount == _inboxCapacity)
+                {
+                    _inboxHead = (_inboxHead + 1) % _inboxCapacity;
+                    _inboxCount -= 1;
+                    _stats.dropped += 1;
+                }
+                const int slot = (_inboxHead + _inboxCount) % _inboxCapacity;
+                std::memcpy(&_inbox[static_cast<size_t>(slot) * (_dimension + 1)], payload.data(), solution);
+                _inboxCount += 1;
+            }
+        }
+    }
+
+public:
+    ClusterWorker(const std::string& path, int dimension, int inboxCapacity)
+        : _dimension(dimension), _packed(dimension + 1), _inboxCapacity(std::max(1, inboxCapacity))
+    {   // connects (waiting up to 10s for the coordinator to listen) and learns the worker's rank and seed
+        _inbox.resize(static_cast<size_t>(_inboxCapacity) * (dimension + 1));
+        _connection = cluster::Connection(cluster::connectTo(path, 10));
+        const int32_t hello = dimension;
+        _connection.send(cluster::Message::hello, &hello, sizeof(hello));
+        cluster::Message type;
+        std::vector<char> payload;
+        if(!_connection.receive(type, payload) || type != cluster::Message::welcome
+           || payload.size() != sizeof(cluster::Welcome))
+            throw ClusterError("the coordinator at " + path + " turned the worker away (a different dimension, or "
+                               "all its workers have joined)");
+        cluster::Welcome welcome;
+        std::memcpy(&welcome, payload.data(), sizeof(welcome));
+        _rank = welcome.rank;
+        _processes = welcome.processes;
+        _seed = welcome.seed;
+        _receiver = std::thread(&ClusterWorker::receiveLoop, this);
+    }
+
+    ClusterWorker(const ClusterWorker&) = delete;
+    ClusterWorker& operator=(const ClusterWorker&) = delete;
+
+    ~ClusterWorker()
+    {
+        _connection.shutdown();
+        _receiver.join();
+    }
+
+    int rank() const { return _rank; }
+    int processes() const { return _processes; }
+    uint64_t seed() const { return _seed; }
+
+    ClusterStats stats()
+    {
+        std::lock_guard<std::mutex> lock(_guard);
+        return _stats;
+    }
+
+    long lease(long n)
+    {   // up to max(n, leaseSize) more evaluations from the coordinator, 0 once the run's budget is spent.
+        // One call at a time (the budget's lease lock)
+        const int64_t wanted = std::max(n, cluster::leaseSize);
+        {
+            std::lock_guard<std::mutex> lock(_guard);
+            _grant = -1;
+        }
+        {
+            std::lock_guard<std::mutex> lock(_sendGuard);
+            if(!post(cluster::Message::lease, &wanted, sizeof(wanted))) return 0;
+        }
+        std::unique_lock<std::mutex> lock(_guard);
+        _answered.wait(lock, [&]{ return _grant >= 0 || _closed; });
+        if(_grant < 0) return 0;
+        _leased += _grant;
+        return _grant;
+    }
+
+    long leased() const { return _leased; }
+
+    template <typename S>
+    void send(const S& migrant)
+    {   // a migrant for the neighbouring processes
+        std::lock_guard<std::mutex> lock(_sendGuard);
+        cluster::pack(migrant, _dimension, _packed.data());
+        if(post(cluster::Message::migrant, _packed.data(), sizeof(float) * _packed.size()))
+        {
+            std::lock_guard<std::mutex> counted(_guard);
+            _stats.sent += 1;
+        }
+    }
+
+    template <typename S>
+    bool receive(S& migrant)
+    {   // the oldest migrant from another process not yet taken in, if any
+        std::lock_guard<std::mutex> lock(_guard);
+        if(_inboxCount == 0) return false;
+        cluster::unpack(&_inbox[static_cast<size_t>(_inboxHead) * (_dimension + 1)], _dimension, migrant);
+        _inboxHead = (_inboxHead + 1) % _inboxCapacity;
+        _inboxCount -= 1;
+        _stats.received += 1;
+        return true;
+    }
+
+    template <typename S>
+    void reportBest(const S& best)
+    {   // only sent when it improves on the last one reported
+        std::lock_guard<std::mutex> lock(_sendGuard);
+        if(!(best.getEval() < _bestReported)) return;
+        _bestReported = best.getEval();
+        cluster::pack(best, _dimension, _packed.data());
+        post(cluster::Message::best, _packed.data(), sizeof(float) * _packed.size());
+    }
+
+    template <typename S>
+    void finish(long used, const S& best)
+    {   // report the evaluations used and the final best, then wait for the coordinator to hang up
+        std::vector<char> payload(sizeof(int64_t) + sizeof(float) * (_dimension + 1));
+        const int64_t evaluations = used;
+        std::memcpy(payload.data(), &evaluations, sizeof(evaluations));
+        {
+            std::lock_guard<std::mutex> lock(_sendGuard);
+            cluster::pack(best, _dimension, _packed.data());
+            std::memcpy(payload.data() + sizeof(evaluations), _packed.data(), sizeof(float) * _packed.size());
+            post(cluster::Message::done, payload.data(), payload.size());
+        }
+        std::unique_lock<std::mutex> lock(_guard);
+        _answered.wait(lock, [&]{ return _closed; });
+    }
+};
+
+class ClusterCoordinator
+{   // holds the run's budget and best, relays migrants between the workers, all on the thread in run()
+private:
+    struct Worker
+    {
+        cluster::Connection connection;
+        bool joined = false;
+        bool done = false;
+        long leased = 0;
+    };
+
+    GAConfig _config;
+    int _dimension;
+    std::string _path;
+    int _listener = -1;
+    uint64_t _seed;
+    Philox _random;                   // random topology: which neighbour a migrant goes to
+    std::vector<Worker> _workers;
+    std::vector<std::vector<int>> _neighbours;
+    long _remaining;                  // of "max_eval", not leased to any worker
+    long _evaluations = 0;            // used by the workers that finished
+    long _relayed = 0;
+    std::vector<float> _best;         // objective then coordinates, empty until a worker reported
+
+    void updateBest(const char* packed)
+    {
+        const float* s = reinterpret_cast<const float*>(packed);
+        if(_best.empty() || s[0] < _best[0]) _best.assign(s, s + _dimension + 1);
+    }
+
+    void relay(int from, const std::vector<char>& migrant)
+    {   // to every neighbouring process still running, or one at random under the random topology
+        auto forward = [&](int to)
+        {
+            Worker& worker = _workers[to];
+            if(!worker.joined || worker.done) return;
+            try
+            {
+                worker.connection.send(cluster::Message::migrant, migrant.data(), migrant.size());
+                _relayed += 1;
+            }catch(const ClusterError&) {} // its end of the connection is read below
+        };
+        const std::vector<int>& out = _neighbours[from];
+        if(out.empty()) return;
+        if(_config.migrationTopology == MigrationTopology::random)
+            forward(out[std::uniform_int_distribution<int>(0, out.size()-1)(_random)]);
+        else for(int to : out) forward(to);
+    }
+
+    void finishWorker(int rank, long used)
+    {   // what the worker leased but did not use goes back to the others
+        Worker& worker = _workers[rank];
+        worker.done = true;
+        worker.connection.close();
+        _remaining += std::max(0L, worker.leased - used);
+        _evaluations += std::min(used, worker.leased);
+    }
+
+    bool admit(cluster::Connection& connection, cluster::Message type, const std::vector<char>& payload, int rank)
+    {   // a new connection's hello, it becomes worker rank if it runs the same dimension. Others are
+        // turned away (closed) without taking up a rank
+        int32_t dimension = -1;
+        if(type == cluster::Message::hello && payload.size() == sizeof(dimension))
+            std::memcpy(&dimension, payload.data(), sizeof(dimension));
+        if(dimension != _dimension || rank >= static_cast<int>(_workers.size()))
+        {
+            if(_config.verbose) THREADPRINT("--a worker of dimension " << dimension << " was turned away\n")
+            connection.close();
+            return false;
+        }
+        Worker& worker = _workers[rank];
+        worker.connection = std::move(connection);
+        const cluster::Welcome welcome{rank, static_cast<int32_t>(_workers.size()), _seed};
+        try
+        {
+            worker.connection.send(cluster::Message::welcome, &welcome, sizeof(welcome));
+        }catch(const ClusterError&)
+        {
+            worker.connection.close();
+            return false;
+        }
+        worker.joined = true;
+        if(_config.verbose) THREADPRINT("--worker " << rank << " joined\n")
+        return true;
+    }
+
+    bool handle(int rank, cluster::Message type, const std::vector<char>& payload)
+    {   // one message of worker rank, true once it is done
+        Worker& worker = _workers[rank];
+        const size_t solution = sizeof(float) * (_dimension + 1);
+        switch(type)
+        {
+            case cluster::Message::lease:
+            {
+                int64_t wanted = 0;
+                if(payload.size() == sizeof(wanted)) std::memcpy(&wanted, payload.data(), sizeof(wanted));
+                const int64_t granted = std::max<int64_t>(0, std::min<int64_t>(wanted, _remaining));
+                _remaining -= granted;
+                worker.leased += granted;
+                worker.connection.send(cluster::Message::grant, &granted, sizeof(granted));
+                return false;
+            }
+            case cluster::Message::migrant:
+                if(payload.size() == solution) relay(rank, payload);
+                return false;
+            case cluster::Message::best:
+                if(payload.size() == solution) updateBest(payload.data());
+                return false;
+            case cluster::Message::done:
+            {
+                int64_t used = worker.leased;
+                if(payload.size() == sizeof(used) + solution)
+                {
+                    std::memcpy(&used, payload.data(), sizeof(used));
+                    updateBest(payload.data() + sizeof(used));
+                }
+                finishWorker(rank, used);
+                if(_config.verbose) THREADPRINT("--worker " << rank << " finished after " << used << " evaluations\n")
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+public:
+    ClusterCoordinator(const GAConfig& config, int dimension)
+        : _config(config), _dimension(dimension), _path(config.coordinatorSocket), _workers(config.processes),
+          _neighbours(topologyNeighbours(config.processes, config.migrationTopology)), _remaining(config.maxEvaluations)
+    {   // listens from here on, so workers started right after can connect. Without a "seed" one is taken
+        // from the clock, as GA does
+        _seed = config.seed >= 0 ? config.seed
+                                 : std::chrono::high_resolution_clock::now().time_since_epoch().count() & ((1LL << 48) - 1);
+        _random = Philox(_seed, std::numeric_limits<uint32_t>::max()); // a stream no worker uses
+        _listener = cluster::listenOn(_path);
+    }
+
+    ClusterCoordinator(const ClusterCoordinator&) = delete;
+    ClusterCoordinator& operator=(const ClusterCoordinator&) = delete;
+
+    ~ClusterCoordinator()
+    {
+        if(_listener >= 0) close(_listener);
+        unlink(_path.c_str());
+    }
+
+    uint64_t seed() const { return _seed; }
+    long evaluations() const { return _evaluations; }
+    long relayed() const { return _relayed; }
+    const std::vector<float>& best() const { return _best; }
+
+    void run()
+    {   // until every one of the "processes" workers has joined and finished (or gone away)
+        if(_config.verbose) THREADPRINT("--coordinator listening on " << _path << " for " << _workers.size()
+                                        << " workers, seed = " << _seed << '\n')
+        const int processes = _workers.size();
+        int joined = 0;
+        int finished = 0;
+        std::vector<cluster::Connection> pending; // accepted, their hello not yet read
+        std::vector<pollfd> fds;
+        std::vector<int> ranks;  // of fds: -1 the listener, -2-i pending[i], else the worker's rank
+        cluster::Message type;
+        std::vector<char> payload;
+        while(finished < processes)
+        {
+            fds.clear();
+            ranks.clear();
+            if(joined < processes)
+            {
+                fds.push_back({_listener, POLLIN, 0});
+                ranks.push_back(-1);
+            }
+            for(int i=0; i<pending.size(); i++)
+            {
+                fds.push_back({pending[i].fd(), POLLIN, 0});
+                ranks.push_back(-2 - i);
+            }
+            for(int r=0; r<joined; r++)
+            {
+                if(_workers[r].done) continue;
+                fds.push_back({_workers[r].connection.fd(), POLLIN, 0});
+                ranks.push_back(r);
+            }
+            if(poll(fds.data(), fds.size(), -1) < 0)
+            {
+                if(errno == EINTR) continue;
+                throw ClusterError(std::string("the coordinator cannot wait for its workers: ") + std::strerror(errno));
+            }
+            for(size_t k=0; k<fds.size(); k++)
+            {
+                if(fds[k].revents == 0) continue;
+                if(ranks[k] == -1)
+                {
+                    int fd = accept4(_listener, nullptr, nullptr, SOCK_CLOEXEC);
+                    if(fd >= 0) pending.emplace_back(fd);
+                    continue;
+                }
+                cluster::Connection& connection = ranks[k] < -1 ? pending[-2 - ranks[k]] : _workers[ranks[k]].connection;
+                bool open;
+                try
+                {
+                    open = connection.receive(type, payload);
+                }catch(const ClusterError&)
+                {
+                    open = false;
+                }
+                if(ranks[k] < -1)
+                {
+                    if(!open) connection.close();
+                    else if(admit(connection, type, payload, joined)) joined += 1;
+                    continue;
+                }
+                const int rank = ranks[k];
+                if(!open)
+                {   // gone without a word, everything it leased counts as used
+                    if(_config.verbose) THREADPRINT("--worker " << rank << " went away\n")
+                    finishWorker(rank, _workers[rank].leased);
+                    finished += 1;
+                }else if(handle(rank, type, payload)) finished += 1;
+            }
+            // connections admitted or turned away leave pending
+            pending.erase(std::remove_if(pending.begin(), pending.end(), 
+                                         [](const cluster::Connection& c){ return c.fd() < 0; }), pending.end());
+        }
+        if(_config.verbose) THREADPRINT("--cluster: " << processes << " workers used " << _evaluations
+                                        << " evaluations of a budget of " << _config.maxEvaluations << ", "
+                                        << _relayed << " migrants relayed\n")
+    }
+};
+
+#endif // INCLUDE_GA_CLUSTER
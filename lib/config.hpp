@@ -0,0 +1,261 @@
+#ifndef INCLUDE_GA_CONFIG
+#define INCLUDE_GA_CONFIG
+
+#include <string>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include "../third_party/nlohmann/json.hpp"
+#include "profile.hpp"
+
+/* Typed run configuration, parsed and validated once from the parameters json before the GA starts.
+
+   The core and each problem read their own keys out of the same json object through a shared
+   ConfigReader, then ConfigReader::finish() rejects any key nobody consumed (usually a typo). Keys
+   present since the first version of parameters.json are required, newer keys are optional with
+   the defaults documented next to them. */
+
+class ConfigError : public std::runtime_error
+{
+public:
+    explicit ConfigError(const std::string& what) : std::runtime_error(what) {}
+};
+
+class ConfigReader
+{
+private:
+    const nlohmann::json& _json;
+    std::set<std::string> _used;
+
+    template <typename V>
+    V convert(const std::string& key, const nlohmann::json& value)
+    {   // numbers must be numbers, booleans booleans and strings strings
+        bool ok;
+        if constexpr(std::is_same<V, bool>::value) ok = value.is_boolean();
+        else if constexpr(std::is_arithmetic<V>::value) ok = value.is_number();
+        else ok = value.is_string();
+        if(!ok) throw ConfigError("parameter \"" + key + "\" has the wrong type (" + value.dump() + ")");
+        if constexpr(std::is_integral<V>::value && !std::is_same<V, bool>::value)
+        {
+            double d = value.get<double>();
+            if(d != static_cast<double>(static_cast<V>(d)))
+                throw ConfigError("parameter \"" + key + "\" must be a whole number (" + value.dump() + ")");
+            return static_cast<V>(d);
+        }
+        return value.get<V>();
+    }
+
+public:
+    explicit ConfigReader(const nlohmann::json& json) : _json(json)
+    {
+        if(!_json.is_object()) throw ConfigError("parameters must be a json object");
+    }
+
+    bool has(const std::string& key) const { return _json.contains(key); }
+
+    template <typename V>
+    V get(const std::string& key)
+    {   // a required parameter
+        auto it = _json.find(key);
+        if(it == _json.end()) throw ConfigError("missing parameter \"" + key + "\"");
+        _used.insert(key);
+        return convert<V>(key, *it);
+    }
+
+    template <typename V>
+    V get(const std::string& key, V fallback)
+    {   // an optional parameter
+        auto it = _json.find(key);
+        if(it == _json.end()) return fallback;
+        _used.insert(key);
+        return convert<V>(key, *it);
+    }
+
+    const nlohmann::json* raw(const std::string& key)
+    {   // an optional parameter of any json type (nullptr when absent), the caller checks its shape
+        auto it = _json.find(key);
+        if(it == _json.end()) return nullptr;
+        _used.insert(key);
+        return &*it;
+    }
+
+    void finish() const
+    {   // every key must have been read by someone
+        std::stringstream unknown;
+        for(auto it = _json.begin(); it != _json.end(); ++it)
+        {
+            if(_used.count(it.key()) == 0) unknown << (unknown.tellp() > 0 ? ", " : "") << '"' << it.key() << '"';
+        }
+        if(unknown.tellp() > 0) throw ConfigError("unknown parameter(s) " + unknown.str());
+    }
+};
+
+// throw a ConfigError with message unless condition holds
+void require(bool condition, const std::string& message)
+{
+    if(!condition) throw ConfigError(message);
+}
+
+// how islands (one per thread) are connected for migration, see migration.hpp
+enum class MigrationTopology { ring, torus, fullyConnected, random };
+
+// which solutions an island sends when it migrates
+enum class MigrationPolicy { best, random };
+
+// how population snapshots ("print every") are written, see snapshot.hpp
+enum class SnapshotFormat { text, binary };
+
+// which entry a full fitness cache evicts, see cache.hpp
+enum class CacheEviction { clock, lru };
+
+// what an island that has converged does, see convergence.hpp
+enum class ConvergencePolicy { none, stop, restart, boost };
+
+struct GAConfig
+{   // parameters of the GA core
+    int maxIterations;        // "max_iterations", generations per thread
+    int populationSize;       // "population size"
+    int numberOfThreads;      // "number of Threads", number of islands, each evolving its own share of the population
+    int printEvery;           // "print every", generations between population snapshots
+    int swapPopulationEvery;  // "swap population every", generations between migrations
+    bool printResults;        // "print results", write populationInitial.txt and populationEnd.txt
+    bool structureOfArrays;   // "structure of arrays" (default true), population layout
+    MigrationTopology migrationTopology = MigrationTopology::random; // "migration topology" (default "random"):
+                              // "ring", "torus", "fully connected" or "random" (one random island each time)
+    int migrants = 1;         // "migrants" (default 1), solutions an island sends per migration
+    MigrationPolicy migrationPolicy = MigrationPolicy::random; // "migration policy" (default "random"): "best" or "random"
+    long maxEvaluations = -1; // "max_eval", evaluation budget of the whole run (-1, unlimited, is only for programmatic use)
+    int workerThreads = 0;    // "worker threads" (default 0, one per hardware thread), size of the pool running the islands
+    long long seed = -1;      // "seed" (default -1, taken from the clock and printed), master seed of every random
+                              // stream, 0 <= seed < 2^53 so it survives the json round trip
+    bool reproducible = true; // "reproducible" (default true), islands migrate in lockstep rounds and split the
+                              // budget evenly, so a seed gives the same run with any number of worker threads
+    SnapshotFormat snapshotFormat = SnapshotFormat::text; // "snapshot format" (default "text"): "text" or "binary"
+    bool snapshotCompression = false; // "snapshot compression" (default false), zlib compressed binary snapshots
+    double checkpointEvery = 0; // "checkpoint every" (default 0, never), seconds between checkpoints
+    std::string checkpointFile = "checkpoint.gackpt"; // "checkpoint file" (default "checkpoint.gackpt")
+    bool verbose = true;      // "verbose" (default true), progress messages on stdout
+    std::string profileReport = "profile.json";      // "profile report" (default "profile.json"), and
+    std::string profileTrace = "profile_trace.json"; // "profile trace" (default "profile_trace.json"), where
+                              // a GA_PROFILE build writes its timings, "" for none (see profile.hpp)
+    long cacheCapacity = 0;   // "cache capacity" (default 0, no cache), solutions whose fitness is cached (see cache.hpp)
+    float cacheResolution = 0; // "cache resolution" (default 0, exact), grid the cache keys coordinates on
+    CacheEviction cacheEviction = CacheEviction::clock; // "cache eviction" (default "clock"): "clock" or "lru"
+    bool steadyState = false; // "steady state" (default false), candidates are evaluated asynchronously and each
+                              // replaces the worst as soon as it is done (see runSteadyState in core.hpp)
+    int maxInFlight = 0;      // "max in flight" (default 0, twice the evaluation workers), candidates queued or
+                              // being evaluated at a time in a steady state run
+    std::string evaluator;    // "evaluator" (default "", in process), command of the worker processes a steady
+                              // state run evaluates with (see evaluator.hpp)
+    int evaluatorProcesses = 1; // "evaluator processes" (default 1), how many of them run side by side
+    int processes = 1;        // "processes" (default 1), workers of a cluster run (see cluster.hpp)
+    std::string coordinatorSocket = "ga_coordinator.sock"; // "coordinator socket" (default "ga_coordinator.sock"),
+                              // the Unix socket the workers of a cluster reach the coordinator at
+    ConvergencePolicy convergencePolicy = ConvergencePolicy::none; // "convergence policy" (default "none"): "stop",
+                              // "restart" or "boost", what an island that has converged does (see convergence.hpp)
+    int stagnationGenerations = 50; // "stagnation generations" (default 50), an island whose best has not improved
+                              // for this many generations has converged
+    float stagnationTolerance = 0; // "stagnation tolerance" (default 0), improvements of the best by this fraction
+                              // or less do not count
+    float convergenceDiversity = 0; // "convergence diversity" (default 0, off), an island whose mean fitness is
+                              // within this of its best has also converged
+    float boostFactor = 2;    // "boost factor" (default 2), how much a boosted island scales its mutation
+
+    static GAConfig read(ConfigReader& reader)
+    {
+        GAConfig c;
+        c.maxIterations = reader.get<int>("max_iterations");
+        c.populationSize = reader.get<int>("population size");
+        c.numberOfThreads = reader.get<int>("number of Threads");
+        c.printEvery = reader.get<int>("print every");
+        c.swapPopulationEvery = reader.get<int>("swap population every");
+        c.printResults = reader.get<bool>("print results");
+        c.structureOfArrays = reader.get<bool>("structure of arrays", true);
+
+        std::string topology = reader.get<std::string>("migration topology", "random");
+        if(topology == "ring") c.migrationTopology = MigrationTopology::ring;
+        else if(topology == "torus") c.migrationTopology = MigrationTopology::torus;
+        else if(topology == "fully connected") c.migrationTopology = MigrationTopology::fullyConnected;
+        else if(topology == "random") c.migrationTopology = MigrationTopology::random;
+        else throw ConfigError("unknown migration topology \"" + topology + "\" (ring, torus, fully connected or random)");
+        c.migrants = reader.get<int>("migrants", 1);
+        std::string policy = reader.get<std::string>("migration policy", "random");
+        if(policy == "best") c.migrationPolicy = MigrationPolicy::best;
+        else if(policy == "random") c.migrationPolicy = MigrationPolicy::random;
+        else throw ConfigError("unknown migration policy \"" + policy + "\" (best or random)");
+        c.workerThreads = reader.get<int>("worker threads", 0);
+        c.maxEvaluations = reader.get<long>("max_eval");
+        c.seed = reader.get<long long>("seed", -1);
+        c.reproducible = reader.get<bool>("reproducible", true);
+        std::string format = reader.get<std::string>("snapshot format", "text");
+        if(format == "text") c.snapshotFormat = SnapshotFormat::text;
+        else if(format == "binary") c.snapshotFormat = SnapshotFormat::binary;
+        else throw ConfigError("unknown snapshot format \"" + format + "\" (text or binary)");
+        c.snapshotCompression = reader.get<bool>("snapshot compression", false);
+        c.checkpointEvery = reader.get<double>("checkpoint every", 0.0);
+        c.checkpointFile = reader.get<std::string>("checkpoint file", "checkpoint.gackpt");
+        c.verbose = reader.get<bool>("verbose", true);
+        require(profile::enabled || !(reader.has("profile report") || reader.has("profile trace")),
+                "\"profile report\" and \"profile trace\" need a build with GA_PROFILE");
+        c.profileReport = reader.get<std::string>("profile report", "profile.json");
+        c.profileTrace = reader.get<std::string>("profile trace", "profile_trace.json");
+        c.cacheCapacity = reader.get<long>("cache capacity", 0);
+        c.cacheResolution = reader.get<float>("cache resolution", 0.0f);
+        std::string eviction = reader.get<std::string>("cache eviction", "clock");
+        if(eviction == "clock") c.cacheEviction = CacheEviction::clock;
+        else if(eviction == "lru") c.cacheEviction = CacheEviction::lru;
+        else throw ConfigError("unknown cache eviction \"" + eviction + "\" (clock or lru)");
+        c.steadyState = reader.get<bool>("steady state", false);
+        c.maxInFlight = reader.get<int>("max in flight", 0);
+        c.evaluator = reader.get<std::string>("evaluator", "");
+        c.evaluatorProcesses = reader.get<int>("evaluator processes", 1);
+        c.processes = reader.get<int>("processes", 1);
+        c.coordinatorSocket = reader.get<std::string>("coordinator socket", "ga_coordinator.sock");
+        std::string convergence = reader.get<std::string>("convergence policy", "none");
+        if(convergence == "none") c.convergencePolicy = ConvergencePolicy::none;
+        else if(convergence == "stop") c.convergencePolicy = ConvergencePolicy::stop;
+        else if(convergence == "restart") c.convergencePolicy = ConvergencePolicy::restart;
+        else if(convergence == "boost") c.convergencePolicy = ConvergencePolicy::boost;
+        else throw ConfigError("unknown convergence policy \"" + convergence + "\" (none, stop, restart or boost)");
+        c.stagnationGenerations = reader.get<int>("stagnation generations", 50);
+        c.stagnationTolerance = reader.get<float>("stagnation tolerance", 0.0f);
+        c.convergenceDiversity = reader.get<float>("convergence diversity", 0.0f);
+        c.boostFactor = reader.get<float>("boost factor", 2.0f);
+
+        require(c.maxIterations >= 0, "\"max_iterations\" must not be negative");
+        require(c.numberOfThreads >= 1, "\"number of Threads\" must be at least 1");
+        require(c.populationSize / c.numberOfThreads >= 2,
+                "\"population size\" must leave each island at least 2 solutions");
+        require(c.printEvery >= 1, "\"print every\" must be at least 1");
+        require(c.swapPopulationEvery >= 1, "\"swap population every\" must be at least 1");
+        require(c.migrants >= 1 && c.migrants < c.populationSize / c.numberOfThreads,
+                "\"migrants\" must be at least 1 and less than each island's share of the population");
+        require(c.workerThreads >= 0, "\"worker threads\" must not be negative");
+        require(c.maxEvaluations >= c.populationSize, "\"max_eval\" must at least cover the initial population");
+        require(!c.snapshotCompression || c.snapshotFormat == SnapshotFormat::binary,
+                "\"snapshot compression\" needs \"snapshot format\": \"binary\"");
+#ifndef GA_HAVE_ZLIB
+        require(!c.snapshotCompression, "\"snapshot compression\" needs a build with zlib");
+#endif
+        require(c.checkpointEvery >= 0, "\"checkpoint every\" must not be negative");
+        require(c.checkpointEvery == 0 || c.reproducible,
+                "checkpoints need \"reproducible\": true, the islands are only all at rest between lockstep rounds");
+        require(c.seed >= -1 && c.seed < (1LL << 53), "\"seed\" must be within [0, 2^53), or -1 for a seed from the clock");
+        require(c.cacheCapacity >= 0, "\"cache capacity\" must not be negative");
+        require(c.cacheResolution >= 0, "\"cache resolution\" must not be negative");
+        require(!c.steadyState || !c.reproducible,
+                "\"steady state\" needs \"reproducible\": false, evaluations finish in whatever order they take");
+        require(c.maxInFlight >= 0, "\"max in flight\" must not be negative");
+        require(c.evaluator.empty() || c.steadyState, "\"evaluator\" needs \"steady state\": true");
+        require(c.evaluatorProcesses >= 1, "\"evaluator processes\" must be at least 1");
+        require(c.processes >= 1, "\"processes\" must be at least 1");
+        require(c.stagnationGenerations >= 1, "\"stagnation generations\" must be at least 1");
+        require(c.stagnationTolerance >= 0 && c.stagnationTolerance < 1, "\"stagnation tolerance\" must be within [0, 1)");
+        require(c.convergenceDiversity >= 0, "\"convergence diversity\" must not be negative");
+        require(c.boostFactor > 0, "\"boost factor\" must be positive");
+        return c;
+    }
+};
+
+#endif // INCLUDE_GA_CONFIG
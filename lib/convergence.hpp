@@ -0,0 +1,106 @@
+#ifndef INCLUDE_GA_CONVERGENCE
+#define INCLUDE_GA_CONVERGENCE
+
+#include <cmath>
+#include <limits>
+#include "config.hpp"
+#include "ranking.hpp"
+
+/* Convergence monitoring ("convergence policy"), so islands that stopped improving stop spending
+   evaluations. After every generation an island's monitor reads its best and mean fitness off the
+   ranking the generation kept current anyway (see ranking.hpp), so tracking them costs no pass over
+   the population. The island's diversity is the gap between the two, mean - best, which falls to 0
+   as its members collapse onto one point. An island has converged once its best has not improved by
+   more than "stagnation tolerance" (relative) for "stagnation generations", or its diversity fell
+   below "convergence diversity". The policy decides what happens then:
+
+   none     (default) nothing, no monitor runs
+   stop     the island stops, and what is left of its budget goes to the islands still improving
+   restart  every member but the island's best is replaced by a fresh random solution (as many as its
+            budget covers), then the monitor starts over
+   boost    the island migrates every generation, and breeds with its mutation scaled by "boost
+            factor" (for problems that take a mutation scale, see problem.hpp), until its best
+            improves again
+
+   Free-running islands draw on the shared budget, so an island that stops simply leaves the rest to
+   those still drawing. A reproducible run gives each island a fixed share instead. After every
+   lockstep round, the budget that finished islands left is split evenly, in island order, between
+   the islands whose best improved during the round (all of them if none did). The run stays
+   reproducible. */
+
+struct ConvergenceStats
+{
+    long stopped = 0;        // islands stopped by "stop"
+    long restarts = 0;
+    long boosts = 0;
+    long redistributed = 0;  // evaluations handed from finished islands to searching ones
+
+    ConvergenceStats& operator+=(const ConvergenceStats& other)
+    {
+        stopped += other.stopped;
+        restarts += other.restarts;
+        boosts += other.boosts;
+        redistributed += other.redistributed;
+        return *this;
+    }
+};
+
+class ConvergenceMonitor
+{   // one island's, observe() after each of its generations
+private:
+    int _window = 1;         // "stagnation generations"
+    float _tolerance = 0;    // "stagnation tolerance"
+    float _diversityFloor = 0; // "convergence diversity"
+    float _record = std::numeric_limits<float>::max(); // the best fitness that counted as an improvement
+    float _best = std::numeric_limits<float>::max();
+    float _mean = std::numeric_limits<float>::max();
+    int _stalled = 0;        // generations since the best last improved
+    long _improvements = 0;  // generations that improved the best
+    long _marked = 0;        // _improvements at mark()
+
+public:
+    ConvergenceMonitor() = default;
+
+    explicit ConvergenceMonitor(const GAConfig& config)
+        : _window(config.stagnationGenerations), _tolerance(config.stagnationTolerance),
+          _diversityFloor(config.convergenceDiversity) {}
+
+    bool observe(const Ranking& ranking)
+    {   // the generation just run left the island ranked as ranking, true once the island has converged
+        _best = ranking[0].first;
+        _mean = ranking.mean();
+        if(_best < _record - _tolerance * std::fabs(_record))
+        {
+            _record = _best;
+            _stalled = 0;
+            _improvements += 1;
+        }else _stalled += 1;
+        return _stalled >= _window || diversity() < _diversityFloor;
+    }
+
+    void restart()
+    {   // wait another "stagnation generations" before the island counts as converged again
+        _stalled = 0;
+    }
+
+    void mark() { _marked = _improvements; }
+    bool improvedSinceMark() const { return _improvements > _marked; }
+
+    float best() const { return _best; }
+    float mean() const { return _mean; }
+    float diversity() const { return _mean - _best; }
+    long improvements() const { return _improvements; }
+
+    template <typename Archive>
+    void checkpoint(Archive& archive)
+    {   // the state, not the parameters, see checkpoint.hpp
+        archive.io(_record);
+        archive.io(_best);
+        archive.io(_mean);
+        archive.io(_stalled);
+        archive.io(_improvements);
+        archive.io(_marked);
+    }
+};
+
+#endif // INCLUDE_GA_CONVERGENCE
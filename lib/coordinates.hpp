@@ -0,0 +1,173 @@
+#ifndef INCLUDE_GA_COORDINATES
+#define INCLUDE_GA_COORDINATES
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <algorithm>
+#include <type_traits>
+#include <cassert>
+
+/* Coordinate storage for real-vector solutions.
+
+   Coordinates<D> with D > 0 is a plain float[D] kept inline in the solution, so copies stay on the
+   stack and loops over the dimension are unrolled at compile time. Coordinates<0> takes its
+   dimension at runtime and keeps the floats in fixed-size blocks handed out by BlockPool, which
+   carves them from large contiguous chunks and recycles them through per-thread free lists, so
+   creating and destroying solutions in the generation loop does not go through malloc. */
+
+class BlockPool
+{
+private:
+    static constexpr int blocksPerChunk = 4096;
+
+    struct Shared
+    {   // chunks are only released at process exit, so a block freed on another thread stays valid
+        std::mutex guard;
+        std::vector<std::unique_ptr<float[]>> chunks;
+        std::unordered_map<int, std::vector<float*>> freeBlocks; // returned by exiting threads
+    };
+
+    static Shared& shared()
+    {   // intentionally leaked so it outlives every thread_local cache during shutdown
+        static Shared* s = new Shared;
+        return *s;
+    }
+
+    struct Cache
+    {   // per-thread free lists keyed by block size
+        std::unordered_map<int, std::vector<float*>> freeBlocks;
+
+        ~Cache()
+        {
+            Shared& s = shared();
+            std::lock_guard<std::mutex> lock(s.guard);
+            for(auto& kv : freeBlocks)
+            {
+                auto& dst = s.freeBlocks[kv.first];
+                dst.insert(dst.end(), kv.second.begin(), kv.second.end());
+            }
+        }
+    };
+
+    static Cache& cache()
+    {
+        static thread_local Cache c;
+        return c;
+    }
+
+    static void refill(int size, std::vector<float*>& local)
+    {   // take back blocks released by finished threads, or carve a new chunk
+        Shared& s = shared();
+        std::lock_guard<std::mutex> lock(s.guard);
+        auto it = s.freeBlocks.find(size);
+        if(it != s.freeBlocks.end() && !it->second.empty())
+        {
+            local.swap(it->second);
+            return;
+        }
+        s.chunks.emplace_back(new float[static_cast<size_t>(size) * blocksPerChunk]);
+        float* chunk = s.chunks.back().get();
+        local.reserve(blocksPerChunk);
+        for(int i=blocksPerChunk-1; i>=0; i--) local.push_back(chunk + static_cast<size_t>(i) * size);
+    }
+
+public:
+    static float* allocate(int size)
+    {   // a block of size floats (uninitialised)
+        auto& local = cache().freeBlocks[size];
+        if(local.empty()) refill(size, local);
+        float* p = local.back();
+        local.pop_back();
+        return p;
+    }
+
+    static void release(float* p, int size)
+    {
+        cache().freeBlocks[size].push_back(p);
+    }
+};
+
+template <int D>
+class Coordinates
+{   // compile-time dimension, stored inline
+private:
+    float _x[D];
+
+public:
+    explicit Coordinates(int dimension = D) { assert(dimension == D); }
+
+    static constexpr int size() { return D; }
+    float* data() { return _x; }
+    const float* data() const { return _x; }
+    float& operator[](int i) { return _x[i]; }
+    float operator[](int i) const { return _x[i]; }
+};
+
+template <>
+class Coordinates<0>
+{   // runtime dimension, stored in a pooled block
+private:
+    float* _x;
+    int _dimension;
+
+public:
+    explicit Coordinates(int dimension = 0) : _x(nullptr), _dimension(dimension)
+    {
+        if(_dimension > 0) _x = BlockPool::allocate(_dimension);
+    }
+
+    Coordinates(const Coordinates& other) : Coordinates(other._dimension)
+    {
+        std::copy(other._x, other._x + _dimension, _x);
+    }
+
+    Coordinates(Coordinates&& other) noexcept : _x(other._x), _dimension(other._dimension)
+    {
+        other._x = nullptr;
+        other._dimension = 0;
+    }
+
+    Coordinates& operator=(const Coordinates& other)
+    {
+        if(this == &other) return *this;
+        if(_dimension != other._dimension)
+        {
+            if(_x) BlockPool::release(_x, _dimension);
+            _dimension = other._dimension;
+            _x = _dimension > 0 ? BlockPool::allocate(_dimension) : nullptr;
+        }
+        std::copy(other._x, other._x + _dimension, _x);
+        return *this;
+    }
+
+    Coordinates& operator=(Coordinates&& other) noexcept
+    {
+        std::swap(_x, other._x);
+        std::swap(_dimension, other._dimension);
+        return *this;
+    }
+
+    ~Coordinates()
+    {
+        if(_x) BlockPool::release(_x, _dimension);
+    }
+
+    int size() const { return _dimension; }
+    float* data() { return _x; }
+    const float* data() const { return _x; }
+    float& operator[](int i) { return _x[i]; }
+    float operator[](int i) const { return _x[i]; }
+};
+
+// call f(std::integral_constant<int, D>{}) for the D in Dims equal to dimension, or with D = 0
+// (runtime dimension) when dimension is not one of the pre-instantiated sizes
+template <int... Dims, typename F>
+void dispatchDimension(int dimension, F&& f)
+{
+    bool matched = ((dimension == Dims ? (f(std::integral_constant<int, Dims>{}), true) : false) || ...);
+    if(!matched) f(std::integral_constant<int, 0>{});
+}
+
+#endif // INCLUDE_GA_COORDINATES
@@ -3,12 +3,27 @@
 
 #include <vector>
 #include <memory>
-#include <ctime>
 #include <cstdlib>
 #include "solution.hpp"
 #include <unordered_map>
 #include <thread>
 #include "utils.hpp"
+#include "population.hpp"
+#include "problem.hpp"
+#include "ranking.hpp"
+#include "migration.hpp"
+#include "threadpool.hpp"
+#include "budget.hpp"
+#include "random.hpp"
+#include "snapshot.hpp"
+#include "checkpoint.hpp"
+#include "cache.hpp"
+#include "evaluator.hpp"
+#include "cluster.hpp"
+#include "convergence.hpp"
+#include "config.hpp"
+#include "allocation.hpp"
+#include "profile.hpp"
 #include <algorithm>
 #include <fstream>
 #include <atomic>
@@ -16,66 +31,135 @@
 #include <shared_mutex>
 #include <filesystem>
 
-static int unique_id = 0;
-
-int generateThreadID()
-{   // generate a new unique id each time this method is called
-    unique_id += 1;
-    return unique_id;
-}
-
-// problem specific methods (to be defined for each optimisation problem)
-template <typename T>
-struct ProblemCtx
-{   
-    void (*setRandomGenerator)(std::mt19937);
-    std::vector<T> (*getRandomSolutions)(int, std::unordered_map<std::string, float>&);
-    std::pair<std::vector<int>, std::vector<std::pair<float, int>>> 
-        (*getParentIdx)(std::vector<T>&, int, int, std::unordered_map<std::string, float>&);
-    std::vector<T> (*getChildren)(std::vector<T>&, std::vector<int>&, std::unordered_map<std::string, float>&);
-    void (*updatePopulation)(std::vector<T>&, std::vector<T>&, std::vector<std::pair<float, int>>, std::unordered_map<std::string, float>&);
-    bool (*endSearch)(std::unordered_map<std::string, float>&);
-};
+// THREADPRINT, unless the run is quiet ("verbose": false)
+#define GAPRINT(...) if(_config.verbose) { THREADPRINT(__VA_ARGS__) }
 
 // a struct to allow change of GA runtime hyperparameters
 struct GA_policy
 {};
 
-template <typename T>
+template <typename Population>
+struct Workspace
+{   // per-island scratch the stages fill in place, so every buffer is reused across generations
+    std::vector<int> parentIdx;
+    Ranking ranking; // kept across generations, see ranking.hpp
+    Population children;
+    typename Population::value_type migrant; // staging copy for migrants in and out of the population
+    Population fresh; // "restart": the random solutions replacing a converged island's members
+
+    void reserve(Population& population)
+    {   // no generation can select more parents than there are solutions
+        parentIdx.reserve(population.size());
+        ranking.rebuild(population, 0, population.size());
+        if(population.size() > 0) migrant = population[0]; // sizes the migrant's storage up front
+    }
+};
+
+// Problem implements the interface documented in problem.hpp, GA is specialised on it at compile time
+template <typename Problem>
 class GA
 {
 private:
-    std::vector<T> _population; 
-    std::vector<T> _sharedPool; // a pool of solutions to be exchanged between subsets of population
-    std::unordered_map<std::string, float> _parameters;
+    static_assert(check_problem<Problem>::value, "");
+    typedef typename Problem::solution_type T;
+    typedef typename Problem::population_type Population;
+
+    Population _population; 
+    MigrationNetwork<T> _migration; // lock-free edges between the islands
+    GAConfig _config;
     GA_policy _policy; // tracks current algorithm state
-    ProblemCtx<T> _problemCtx;
+    Problem _problem;
     std::shared_timed_mutex _populationGuard; // to ensure thread-safe modifications to population
-    std::shared_timed_mutex _sharedPoolGaurd; // to ensure thread-safe mod to _sharedPool
-    std::vector<std::vector<T>> _printerQueue;
+    std::unique_ptr<SnapshotWriter> _snapshots; // "print every" snapshots, written in the background
+
+    struct Island
+    {   // an island's state, carried from one task running its generations to the next
+        int id;
+        int rangeStart; // the island evolves _population[rangeStart:rangeEnd]
+        int rangeEnd;
+        Population population;
+        Problem problem;
+        Workspace<Population> workspace;
+        EvaluationQuota quota; // this island's shard of the evaluation budget
+        Philox randomGenerator; // this island's own stream, lent to the problem while a task runs the island
+        std::unique_ptr<FitnessCache> cache; // a reproducible run's cache of this island, see cache.hpp
+        int progressCounter = 0;
+        bool searching = true;  // false once the island has stopped
+        bool breeding = true;   // steady state: false once the island stopped breeding, see runSteadyState()
+        int nextChild = 0;      // steady state: workspace.children[nextChild:] are still to be queued
+        int inFlight = 0;       // steady state: candidates queued for evaluation
+        Population arrival;     // steady state: the evaluated candidate going into the population
+        ConvergenceMonitor convergence; // see monitorIsland()
+        ConvergenceStats convergenceStats;
+        bool boosted = false;   // "boost": migrating every generation until the best improves
+        long steadyStateAllocations = 0; // heap allocations after the first generation (debug builds only)
+        std::chrono::high_resolution_clock::time_point start;
+
+        Island(int id, int rangeStart, int rangeEnd, Population population, const Problem& problem,
+               EvaluationBudget* budget, Philox randomGenerator)
+            : id(id), rangeStart(rangeStart), rangeEnd(rangeEnd), population(std::move(population)), problem(problem),
+              quota(budget), randomGenerator(randomGenerator), start(std::chrono::high_resolution_clock::now())
+        {
+            workspace.reserve(this->population);
+        }
+    };
+
+    ThreadPool* _pool = nullptr;         // nullptr: the islands take turns on the calling thread
+    bool _inline = false;                // see runIslandsInline()
+    std::vector<std::unique_ptr<Island>> _islands;
+    TaskCounter _running; // islands still searching
+    EvaluationBudget _budget;
+    EvaluationQuota _initialQuota;       // charged for the initial population
+    std::atomic<long> _evaluations{0};   // used by finished islands and the initial population
+    uint64_t _seed;                      // master seed, every random stream of the run derives from it
+    Philox _initialGenerator;            // stream 0, draws the initial population
+    uint32_t _nextStream = 1;            // islands of each optimise() get fresh streams
+    std::unique_ptr<CheckpointFile> _checkpoint; // "checkpoint every", see checkpoint.hpp
+    std::chrono::steady_clock::time_point _lastCheckpoint;
+    long _checkpoints = 0;               // checkpoints written by this optimise()
+    bool _resumed = false;               // the islands were restored by resume(), optimise() continues them
+    std::unique_ptr<FitnessCache> _cache; // the fitness cache free-running islands share
+    CacheStats _cacheStats;              // of the islands' caches so far, see cacheStats()
+    ClusterWorker* _cluster = nullptr;   // this GA is a worker of a cluster, see joinCluster()
+    ConvergenceStats _convergenceStats;  // of the islands so far, see convergenceStats()
 
 public:
-    GA(ProblemCtx<T> problemCtx,
-       std::unordered_map<std::string, float> parameters)
-    {
-        std::srand(std::time(NULL)); // seed the random number generator using current time
-        _problemCtx = problemCtx;
-        _parameters = parameters;
+    GA(Problem problem,
+       const GAConfig& config)
+        : _config(config), _problem(problem), _budget(config.maxEvaluations)
+    {   // without a "seed" one is taken from the clock, printed so the run can be repeated
+        _seed = config.seed >= 0 ? config.seed 
+                                 : std::chrono::high_resolution_clock::now().time_since_epoch().count() & ((1LL << 48) - 1);
+        _initialGenerator = Philox(_seed, 0);
+        GAPRINT("--seed = " << _seed << '\n')
+        if(_config.cacheCapacity > 0 && !caching())
+            GAPRINT("--the problem takes no fitness cache, \"cache capacity\" is ignored\n")
+        if(_config.steadyState && !steadyState())
+            GAPRINT("--the problem cannot breed without evaluating, \"steady state\" is ignored\n")
+        if(_config.convergencePolicy == ConvergencePolicy::boost && !problem_traits::has_setMutationScale<Problem>::value)
+            GAPRINT("--the problem takes no mutation scale, \"boost\" only raises migration\n")
         _policy = {};
     };
 
+    template <typename Parameters>
+    GA(ProblemCtx<T, Population, Parameters> problemCtx,
+       std::remove_const_t<Parameters> parameters,
+       const GAConfig& config)
+        : GA(Problem(problemCtx, parameters), config)
+    {}  // for problems written as a ProblemCtx, ie. Problem = ProblemCtxAdapter<T, Population, Parameters>
+
     void print()
     {   // print curr population to iostream
         for(int i=0; i<_population.size(); i++) std::cout << _population[i] << '\n';
     }
 
-    void printToFile(const std::vector<T>& population, const std::string fileName)
+    void printToFile(const Population& population, const std::string fileName)
     {   // save the current population to fileName in the format for each line: x1, x2,... xn, f
         std::ofstream outfile;
         outfile.open(fileName, std::ios::out|std::ios::trunc);
-        for(T s : population)
+        for(int i=0; i<population.size(); i++)
         {
-            outfile << s << '\n';
+            outfile << population[i] << '\n';
         }
         outfile.close();
     }
@@ -85,179 +169,786 @@ public:
         printToFile(_population, fileName);
     }
 
-    void sendToPrinterQueue(std::vector<T>& localPopulation, int rangeStart, int rangeEnd, int printIdx)
-    {   // updates the _printQueue with this thread's localPopulation
-        if((printIdx > _printerQueue.size()-1) | _printerQueue.empty())
-        {
-            _printerQueue.push_back(std::vector<T>(_population.size()));
-        }
-        int localCounter = 0;
-        for(int i=rangeStart; i<rangeEnd; i++)
-        {
-            _printerQueue[printIdx][i] = localPopulation[localCounter];
-            localCounter += 1;
-        }
+    Population* getPopulation()
+    {   // returns a pointer to the population
+        return &_population;
+    }
+
+    void joinCluster(ClusterWorker* worker)
+    {   // run as a worker of a cluster (see cluster.hpp): the budget is leased from the coordinator and
+        // islands also exchange migrants with the other processes. Before generateInitialPopulation()
+        _cluster = worker;
     }
 
-    void clearPrinterQueue()
-    {   // print everything in _printerQueue
-        for(int i=0; i<_printerQueue.size(); i++)
+    void generateInitialPopulation()
+    {   // use the problem specific population initialisation method, this starts a new evaluation budget
+        profile::Scope phase(profile::Phase::initialisation);
+        _budget.reset(_cluster ? 0 : _config.maxEvaluations);
+        if(_cluster)
         {
-            std::stringstream ss;
-            ss << "Results/iter" << (i+1)*_parameters["print every"] << ".txt";
-            printToFile(_printerQueue[i], ss.str());
+            ClusterWorker* worker = _cluster;
+            _budget.setLease([worker](long n){ return worker->lease(n); });
         }
+        _initialQuota = EvaluationQuota(&_budget);
+        _problem.setEvaluationQuota(&_initialQuota);
+        _problem.setRandomGenerator(&_initialGenerator);
+        _population.clear();
+        _population = _problem.getRandomSolutions(_config.populationSize);
+        _problem.setRandomGenerator(nullptr);
+        _problem.setEvaluationQuota(nullptr);
+        _initialQuota.release();
+        _evaluations = _initialQuota.used();
+        profile::count(profile::Counter::evaluations, _initialQuota.used());
     }
 
-    std::vector<T>* getPopulation()
-    {   // returns a pointer to the population
-        return &_population;
+    long evaluations() const
+    {   // evaluations used so far by this run (the islands' are added as they finish)
+        return _evaluations.load();
     }
 
-    void generateInitialPopulation()
-    {   // use the problem specific population initialisation method
-        _population.clear();
-        _population = _problemCtx.getRandomSolutions(_parameters["population size"], _parameters);
-    }
+    const EvaluationBudget& budget() const { return _budget; }
+
+    uint64_t seed() const { return _seed; }
 
-    std::pair<std::vector<int>, std::vector<std::pair<float, int>>>  getParents(
-        std::vector<T>& population,
-        ProblemCtx<T>& problemCtx, 
-        std::unordered_map<std::string, float>& parameters)
+    void getParents(
+        Population& population,
+        Workspace<Population>& workspace,
+        Problem& problem)
     {   // use the problem specific population parent selection method
-        auto idxAndSortedArr  = problemCtx.getParentIdx(population, 0, population.size(), parameters);
-        return idxAndSortedArr;
+        problem.getParentIdx(population, 0, population.size(), workspace.parentIdx, workspace.ranking);
     }
 
-    std::vector<T> getChildren(
-        std::vector<int>& parentIdx, 
-        std::vector<T>& population, 
-        ProblemCtx<T>& ProblemCtx,
-        std::unordered_map<std::string, float>& parameters)
+    void getChildren(
+        Population& population, 
+        Workspace<Population>& workspace,
+        Problem& problem)
     {   // use the problem specific breeding+mutation method
-        return ProblemCtx.getChildren(population, parentIdx, parameters);
+        problem.getChildren(population, workspace.parentIdx, workspace.children);
     }
 
-    void updatePopulation(std::vector<T>& children, std::vector<std::pair<float, int>>& sortedIdx)
+    void updatePopulation(Population& children, Ranking& ranking)
     {   // use the problem specific population update method
         std::shared_lock<std::shared_timed_mutex> locallock{_populationGuard, std::defer_lock};
-        locallock.lock();
-        _problemCtx.updatePopulation(_population, children, sortedIdx, _parameters);
+        {
+            profile::Wait wait;
+            locallock.lock();
+        }
+        _problem.updatePopulation(_population, children, ranking);
         locallock.unlock();
     }
 
     void updateLocalPopulation(
-        std::vector<T>& population, 
-        std::vector<T>& children, 
-        std::vector<std::pair<float, int>>& sortedIdx,
-        ProblemCtx<T>& ProblemCtx,
-        std::unordered_map<std::string, float>& parameters)
+        Population& population, 
+        Workspace<Population>& workspace,
+        Problem& problem)
     {   // use the problem specific population update method
-        ProblemCtx.updatePopulation(population, children, sortedIdx, parameters);
+        problem.updatePopulation(population, workspace.children, workspace.ranking);
     }
 
-    void optimiseThread(int maxIter, int rangeStart, int rangeEnd)
-    {   // perform GA search on a subset of population
-        // ie. _population[rangeStart:rangeEnd]
-        int threadID = generateThreadID();
-        int progressCounter = 0;
-        int printIdx = 0;
+    void sendMigrants(
+        int island,
+        Population& population,
+        Workspace<Population>& workspace,
+        Philox& randomGenerator)
+    {   // send migrants along the island's outgoing edges
+        profile::IslandScope profiled(island);
+        profile::Scope phase(profile::Phase::migration);
+        Ranking& ranking = workspace.ranking;
+        if(ranking.size() != population.size()) ranking.rebuild(population, 0, population.size());
+        _migration.beginRound(island, randomGenerator);
+        for(int k=0; k<std::min<int>(_config.migrants, population.size()); k++)
+        {
+            int outgoing = _config.migrationPolicy == MigrationPolicy::best 
+                               ? ranking[k].second : intRand(0, population.size()-1, randomGenerator);
+            workspace.migrant = population[outgoing]; // a copy, not a proxy into the SoA layout
+            _migration.send(island, workspace.migrant);
+            profile::count(profile::Counter::migrantsSent);
+        }
+    }
 
-        // create a copy of managed population locally managed by this thread
-        std::vector<T> localPopulation;
-        for(int i=rangeStart; i<rangeEnd; i++) localPopulation.push_back(_population[i]);
+    void receiveMigrants(
+        int island,
+        Population& population,
+        Workspace<Population>& workspace)
+    {   // let whatever has arrived replace the worst members (at most half the island per round)
+        profile::IslandScope profiled(island);
+        profile::Scope phase(profile::Phase::migration);
+        Ranking& ranking = workspace.ranking;
+        if(ranking.size() != population.size()) ranking.rebuild(population, 0, population.size());
+        for(int k=0; k<population.size()/2 && _migration.receive(island, workspace.migrant); k++)
+        {
+            int incoming = ranking.worst(0);
+            float previous = population[incoming].getEval();
+            population[incoming] = workspace.migrant;
+            ranking.update(incoming, previous, workspace.migrant.getEval());
+            profile::count(profile::Counter::migrantsReceived);
+        }
+    }
 
-        // create a copy of resources for this thread
-        auto parameters = _parameters;
-        auto problemCtx = _problemCtx;
-        std::mt19937 randomGenerator;
-        randomGenerator.seed(std::time(NULL));
-        problemCtx.setRandomGenerator(randomGenerator);
+    void migrate(
+        int island,
+        Population& population,
+        Workspace<Population>& workspace,
+        Philox& randomGenerator)
+    {   // one migration round of an island on its own
+        sendMigrants(island, population, workspace, randomGenerator);
+        receiveMigrants(island, population, workspace);
+        if(_cluster) exchangeRemote(island, population, workspace, randomGenerator);
+    }
 
-        // create the required mutex locks for thread-safe usage of shared resources
-        std::unique_lock<std::shared_timed_mutex> sharedPoolLock{_sharedPoolGaurd, std::defer_lock};
-        std::shared_lock<std::shared_timed_mutex> popuLock{_populationGuard, std::defer_lock};
+    void exchangeRemote(
+        int island,
+        Population& population,
+        Workspace<Population>& workspace,
+        Philox& randomGenerator)
+    {   // a cluster worker's island also sends its migrants to the neighbouring processes and takes in
+        // (up to as many of) theirs in place of its worst, and reports its best to the coordinator
+        profile::IslandScope profiled(island);
+        profile::Scope phase(profile::Phase::migration);
+        Ranking& ranking = workspace.ranking;
+        if(ranking.size() != population.size()) ranking.rebuild(population, 0, population.size());
+        const int migrants = std::min<int>(_config.migrants, population.size());
+        for(int k=0; k<migrants; k++)
+        {
+            int outgoing = _config.migrationPolicy == MigrationPolicy::best 
+                               ? ranking[k].second : intRand(0, population.size()-1, randomGenerator);
+            workspace.migrant = population[outgoing];
+            _cluster->send(workspace.migrant);
+            profile::count(profile::Counter::migrantsSent);
+        }
+        workspace.migrant = population[ranking[0].second];
+        _cluster->reportBest(workspace.migrant);
+        for(int k=0; k<migrants && _cluster->receive(workspace.migrant); k++)
+        {
+            int incoming = ranking.worst(0);
+            float previous = population[incoming].getEval();
+            population[incoming] = workspace.migrant;
+            ranking.update(incoming, previous, workspace.migrant.getEval());
+            profile::count(profile::Counter::migrantsReceived);
+        }
+    }
+
+    MigrationStats migrationStats() const
+    {   // totals over every island of the last optimise()
+        return _migration.totalStats();
+    }
+
+    CacheStats cacheStats() const
+    {   // fitness cache totals of the last optimise(), once it returned
+        return _cacheStats;
+    }
+
+    ConvergenceStats convergenceStats() const
+    {   // convergence monitor totals of the last optimise(), once it returned
+        return _convergenceStats;
+    }
+
+    bool caching() const
+    {   // a "cache capacity" and a problem that takes the cache
+        return _config.cacheCapacity > 0 && problem_traits::has_setFitnessCache<Problem>::value;
+    }
+
+    FitnessCache* cacheOf(Island& island)
+    {   // the cache island's generations use, nullptr without one
+        return island.cache ? island.cache.get() : _cache.get();
+    }
 
-        // begin optimisation
-        auto start = std::chrono::high_resolution_clock::now();
-        THREADPRINT("--thread " << threadID << " started handling " << rangeEnd-rangeStart << " solutions\n")
-        while((progressCounter < maxIter) && !problemCtx.endSearch(parameters))
+    void lendCache(Problem& problem, FitnessCache* cache)
+    {
+        if constexpr(problem_traits::has_setFitnessCache<Problem>::value) problem.setFitnessCache(cache);
+    }
+
+    void runIsland(Island& island)
+    {   // one task: the island's generations up to its next migration. Running freely, the island
+        // migrates and queues itself again so a free worker (not necessarily this one) picks it up;
+        // in a reproducible run the migration round is left to optimise() instead
+        profile::IslandScope profiled(island.id);
+        island.problem.setRandomGenerator(&island.randomGenerator);
+        island.problem.setEvaluationQuota(&island.quota);
+        lendCache(island.problem, cacheOf(island));
+        bool migrationDue = false;
+        while(!migrationDue && (island.progressCounter < _config.maxIterations) && !island.quota.exhausted() 
+              && !island.problem.endSearch())
         {
-            progressCounter += 1;
+            island.progressCounter += 1;
+            long allocationsBefore = allocation::threadCount();
+            long evaluationsBefore = island.quota.used();
 
             // perform GA search
-            std::pair<std::vector<int>, std::vector<std::pair<float, int>>> 
-                parentIdxAndSortedArr = getParents(localPopulation, problemCtx, parameters);
-            std::vector<T> children = getChildren(parentIdxAndSortedArr.first, localPopulation, problemCtx, parameters);
-            updateLocalPopulation(localPopulation, children, parentIdxAndSortedArr.second, problemCtx, parameters);
+            {
+                profile::Scope phase(profile::Phase::selection);
+                getParents(island.population, island.workspace, island.problem);
+            }
+            {
+                profile::Scope phase(profile::Phase::breeding);
+                getChildren(island.population, island.workspace, island.problem);
+            }
+            {
+                profile::Scope phase(profile::Phase::replacement);
+                updateLocalPopulation(island.population, island.workspace, island.problem);
+            }
+            profile::count(profile::Counter::evaluations, island.quota.used() - evaluationsBefore);
 
-            // send candidates to sharedPool for inter-thread swapping
-            if(progressCounter % static_cast<int>(parameters["swap population every"]) == 0)
+            // stop, restart or boost the island once it converged
+            if(!monitorIsland(island)) break;
+
+            // exchange solutions with the neighbouring islands
+            if(island.progressCounter % _config.swapPopulationEvery == 0 || island.boosted)
             {
-                int outgoing = intRand(0, localPopulation.size()-1, randomGenerator);
-                sharedPoolLock.lock();
-                if(_sharedPool.empty())
-                {
-                    _sharedPool.push_back(localPopulation[outgoing]);
-                }else
+                if(!_config.reproducible) migrate(island.id, island.population, island.workspace, island.randomGenerator);
+                migrationDue = true;
+            }
+            if(island.progressCounter > 1) island.steadyStateAllocations += allocation::threadCount() - allocationsBefore;
+
+            // hand a snapshot to the writer if needed
+            if(island.progressCounter % _config.printEvery == 0 && _snapshots)
+            {
+                profile::Scope phase(profile::Phase::snapshot);
+                _snapshots->submit(island.id, island.progressCounter, island.population);
+            }
+        }
+        lendCache(island.problem, nullptr);
+        island.problem.setEvaluationQuota(nullptr);
+        island.problem.setRandomGenerator(nullptr);
+        if(!migrationDue) finishIsland(island);
+        else if(_config.reproducible || !_pool) _running.done();
+        else
+        {
+            Island* next = &island;
+            _pool->submit([this, next](){ runIsland(*next); });
+        }
+    }
+
+    bool monitorIsland(Island& island)
+    {   // island's convergence monitor after a generation (see convergence.hpp), which acts on the
+        // "convergence policy" once the island converged. False when the island is to stop
+        if(_config.convergencePolicy == ConvergencePolicy::none) return true;
+        Ranking& ranking = island.workspace.ranking;
+        if(ranking.size() != island.population.size()) ranking.rebuild(island.population, 0, island.population.size());
+        const long improvements = island.convergence.improvements();
+        const bool converged = island.convergence.observe(ranking);
+        if(island.boosted)
+        {   // the boost stays on until it paid off
+            if(island.convergence.improvements() == improvements) return true;
+            boostIsland(island, false);
+        }
+        if(!converged) return true;
+        switch(_config.convergencePolicy)
+        {
+        case ConvergencePolicy::stop:
+            island.convergenceStats.stopped += 1;
+            return false;
+        case ConvergencePolicy::restart:
+            return restartIsland(island);
+        case ConvergencePolicy::boost:
+            boostIsland(island, true);
+            island.convergenceStats.boosts += 1;
+            island.convergence.restart();
+            return true;
+        default:
+            return true;
+        }
+    }
+
+    bool restartIsland(Island& island)
+    {   // every member but island's best replaced by a fresh random solution, as many as its budget
+        // covers (drawn from the island's stream). False when it covers none
+        const long granted = island.quota.acquire(island.population.size() - 1);
+        if(granted == 0) return false;
+        Population& fresh = island.workspace.fresh;
+        island.problem.setEvaluationQuota(nullptr); // charged above
+        if constexpr(problem_traits::has_fillRandomSolutions<Problem>::value) 
+            island.problem.getRandomSolutions(granted, fresh); // in place, one batch
+        else fresh = island.problem.getRandomSolutions(granted);
+        island.problem.setEvaluationQuota(&island.quota);
+        profile::count(profile::Counter::evaluations, granted);
+        Ranking& ranking = island.workspace.ranking;
+        FitnessCache* cache = cacheOf(island);
+        for(int i=0; i<granted; i++)
+        {
+            island.population[ranking.worst(i)] = fresh[i];
+            if(cache) cache->insert(fresh[i], fresh[i].getEval());
+        }
+        ranking.rebuild(island.population, 0, island.population.size());
+        island.convergence.restart();
+        island.convergenceStats.restarts += 1;
+        return true;
+    }
+
+    void boostIsland(Island& island, bool on)
+    {   // "boost": the island migrates every generation and breeds with its mutation scaled by "boost factor"
+        island.boosted = on;
+        if constexpr(problem_traits::has_setMutationScale<Problem>::value)
+            island.problem.setMutationScale(on ? _config.boostFactor : 1.0f);
+    }
+
+    void redistributeBudget(const std::vector<Island*>& searching)
+    {   // a reproducible run's budget left by finished islands, split evenly between the searching islands
+        // that improved during the round (all of them if none did), in island order
+        const long reclaimed = _budget.unlimited() ? 0 : _budget.remaining();
+        if(reclaimed <= 0 || searching.empty()) return;
+        long improving = 0;
+        for(Island* island : searching) if(island->convergence.improvedSinceMark()) improving += 1;
+        const long recipients = improving > 0 ? improving : searching.size();
+        long k = 0;
+        for(Island* island : searching)
+        {
+            if(improving > 0 && !island->convergence.improvedSinceMark()) continue;
+            island->quota.allot(reclaimed / recipients + (k < reclaimed % recipients ? 1 : 0));
+            k += 1;
+        }
+        _convergenceStats.redistributed += reclaimed;
+    }
+
+    bool steadyState() const
+    {   // "steady state" and a problem that can breed without evaluating
+        return _config.steadyState && problem_traits::has_steadyState<Problem>::value;
+    }
+
+    template <typename S>
+    void insertArrival(Island& island, const S& candidate)
+    {   // candidate replaces island's worst member (through the problem's updatePopulation)
+        profile::Scope phase(profile::Phase::replacement);
+        island.arrival[0] = candidate;
+        island.problem.updatePopulation(island.population, island.arrival, island.workspace.ranking);
+    }
+
+    bool queueCandidate(Island& island, EvaluationPipeline<T>& pipeline)
+    {   // queue island's next child for evaluation (a fitness cache hit goes into the population right
+        // away), breeding a new generation of children once the last one's are all queued. False once
+        // the island stopped breeding
+        if(!island.breeding) return false;
+        Workspace<Population>& workspace = island.workspace;
+        if(island.nextChild >= workspace.children.size())
+        {
+            if(island.progressCounter >= _config.maxIterations || island.quota.exhausted() || island.problem.endSearch())
+            {
+                island.breeding = false;
+                return false;
+            }
+            if(island.progressCounter > 0 && !monitorIsland(island))
+            {   // converged on the last generation's arrivals
+                island.breeding = false;
+                return false;
+            }
+            island.progressCounter += 1;
+            {
+                profile::Scope phase(profile::Phase::selection);
+                getParents(island.population, workspace, island.problem);
+            }
+            if constexpr(problem_traits::has_steadyState<Problem>::value)
+            {
+                profile::Scope phase(profile::Phase::breeding);
+                island.problem.breedChildren(island.population, workspace.parentIdx, workspace.children);
+            }
+            island.nextChild = 0;
+            if(island.progressCounter % _config.swapPopulationEvery == 0 || island.boosted)
+                migrate(island.id, island.population, workspace, island.randomGenerator);
+            if(island.progressCounter % _config.printEvery == 0 && _snapshots)
+            {
+                profile::Scope phase(profile::Phase::snapshot);
+                _snapshots->submit(island.id, island.progressCounter, island.population);
+            }
+            return true;
+        }
+        auto&& child = workspace.children[island.nextChild++];
+        FitnessCache* cache = cacheOf(island);
+        float fitness = 0;
+        if(cache && cache->lookup(child, fitness))
+        {
+            child.setEval(fitness);
+            insertArrival(island, child);
+            return true;
+        }
+        if(island.quota.acquire(1) == 0)
+        {   // the budget is spent
+            island.breeding = false;
+            return false;
+        }
+        pipeline.submit(island.id, child);
+        island.inFlight += 1;
+        return true;
+    }
+
+    std::string runSteadyState()
+    {   // "steady state": this thread breeds for the islands in turn and queues their children for
+        // evaluation (at most "max in flight" at a time), then each child replaces its island's worst
+        // member as soon as its evaluation is done, so no island waits for the slowest evaluation of a
+        // generation. Islands migrate every "swap population every" generations bred and finish once
+        // they stopped breeding and their last child arrived. Returns the evaluator's error, if any
+        const int processes = _config.evaluator.empty() ? 0 : _config.evaluatorProcesses;
+        const int workers = processes > 0 ? processes : (_pool ? _pool->size() : 1);
+        const int limit = _config.maxInFlight > 0 ? _config.maxInFlight : 2 * workers;
+        const Problem& evaluator = _problem;
+        std::function<void(T&)> evaluate = [&evaluator](T& s)
+        {
+            if constexpr(problem_traits::has_steadyState<Problem>::value)
+            {
+                profile::Scope phase(profile::Phase::evaluation);
+                evaluator.evaluateSolution(s);
+            }
+        };
+        T prototype = _population[0];
+        EvaluationPipeline<T> pipeline(limit, prototype, evaluate, _pool, _config.evaluator, processes);
+        GAPRINT("--steady state: " << limit << " candidates in flight, evaluated " 
+                    << (processes > 0 ? "by " + std::to_string(processes) + " \"" + _config.evaluator + "\" processes" 
+                                      : std::string("in process")) << '\n')
+
+        int active = 0;
+        for(auto& island : _islands)
+        {
+            island->breeding = island->searching;
+            if(!island->searching) continue;
+            island->arrival = slice(island->population, 0, 1);
+            island->problem.setRandomGenerator(&island->randomGenerator);
+            island->problem.setEvaluationQuota(&island->quota);
+            lendCache(island->problem, cacheOf(*island));
+            active += 1;
+        }
+        _running.add(active);
+        auto arrived = [&](typename EvaluationPipeline<T>::Request& request)
+        {
+            Island& island = *_islands[request.island];
+            island.inFlight -= 1;
+            if(request.failed) return;
+            profile::count(profile::Counter::evaluations);
+            if(FitnessCache* cache = cacheOf(island)) cache->insert(request.solution, request.solution.getEval());
+            insertArrival(island, request.solution);
+        };
+        std::string error;
+        while(active > 0)
+        {
+            // islands take turns queueing a child each while there is room, an evaluator failure stops the breeding
+            error = pipeline.error();
+            bool queued = error.empty();
+            while(queued && !pipeline.full())
+            {
+                queued = false;
+                for(auto& island : _islands)
                 {
-                    int incoming = intRand(0, _sharedPool.size()-1, randomGenerator);
-                    auto tmp = localPopulation[outgoing];
-                    localPopulation[outgoing] = _sharedPool[incoming];
-                    _sharedPool[incoming] = tmp;
+                    if(!pipeline.full() && queueCandidate(*island, pipeline)) queued = true;
                 }
-                sharedPoolLock.unlock();
             }
+            for(auto& island : _islands)
+            {
+                if(!error.empty()) island->breeding = false;
+                if(!island->searching || island->breeding || island->inFlight > 0) continue;
+                lendCache(island->problem, nullptr);
+                island->problem.setEvaluationQuota(nullptr);
+                island->problem.setRandomGenerator(nullptr);
+                finishIsland(*island);
+                active -= 1;
+            }
+            if(active == 0) break;
+            pipeline.collect(arrived, pipeline.inFlight() > 0);
+        }
+        return error;
+    }
 
-            // printing if needed
-            if(progressCounter % static_cast<int>(parameters["print every"]) == 0)
+    void runLockstep()
+    {   // reproducible runs: every round, the islands still searching run up to their next migration in
+        // parallel, then migrate here in island order, all sending before any receives. Which worker
+        // ran which island, and when, then has no effect on the result. Without a pool the islands run
+        // their rounds in turn on this thread (free-running ones having migrated themselves)
+        std::vector<Island*> searching;
+        for(auto& island : _islands) if(island->searching) searching.push_back(island.get());
+        const bool redistributing = _config.reproducible && _config.convergencePolicy != ConvergencePolicy::none;
+        while(!searching.empty())
+        {
+            for(Island* island : searching) island->convergence.mark();
+            _running.add(searching.size());
+            if(_pool)
+            {
+                for(Island* island : searching) _pool->submit([this, island](){ runIsland(*island); });
+                _pool->wait(_running);
+            }else for(Island* island : searching) runIsland(*island);
+            searching.erase(std::remove_if(searching.begin(), searching.end(), 
+                                           [](Island* island){ return !island->searching; }), searching.end());
+            if(_config.reproducible)
             {
-                sendToPrinterQueue(localPopulation, rangeStart, rangeEnd, printIdx);
-                printIdx += 1;
+                for(Island* island : searching) 
+                    sendMigrants(island->id, island->population, island->workspace, island->randomGenerator);
+                for(Island* island : searching) receiveMigrants(island->id, island->population, island->workspace);
             }
+            if(redistributing) redistributeBudget(searching);
+            if(_checkpoint && !searching.empty() && std::chrono::steady_clock::now() - _lastCheckpoint 
+                                                    >= std::chrono::duration<double>(_config.checkpointEvery)) 
+                saveCheckpoint();
         }
+    }
+
+    template <typename Archive>
+    void checkpointState(Archive& archive)
+    {   // the complete state of a run between two lockstep rounds, the same order for every archive
+        const int dimension = populationDimension(_population);
+        const long layout[5] = {static_cast<long>(_population.size()), _config.numberOfThreads, dimension, 
+                                _config.migrants, static_cast<long>(_config.migrationTopology)};
+        long stored[5];
+        std::copy(layout, layout+5, stored);
+        archive.io(stored);
+        if(!Archive::saving && !std::equal(layout, layout+5, stored))
+            throw CheckpointError("the checkpoint was written with a different population size, number of islands, "
+                                  "dimension or migration");
+        archive.io(_seed);
+        archive.io(_nextStream);
+        _initialGenerator.checkpoint(archive);
+        _budget.checkpoint(archive);
+        _initialQuota.checkpoint(archive);
+        long evaluations = _evaluations.load();
+        archive.io(evaluations);
+        if(!Archive::saving) _evaluations = evaluations;
+        for(auto& island : _islands)
+        {
+            archive.io(island->progressCounter);
+            archive.io(island->searching);
+            island->quota.checkpoint(archive);
+            island->randomGenerator.checkpoint(archive);
+            for(int i=0; i<island->population.size(); i++) checkpointSolution(archive, island->population[i], dimension);
+            if(island->cache) island->cache->checkpoint(archive);
+            island->convergence.checkpoint(archive);
+            archive.io(island->convergenceStats);
+            archive.io(island->boosted);
+        }
+        _migration.checkpoint(archive, [&](auto& a, T& migrant){ checkpointSolution(a, migrant, dimension); });
+    }
+
+    void saveCheckpoint()
+    {   // skipped while the previous checkpoint is still being synced, a later round tries again
+        profile::Scope phase(profile::Phase::checkpoint);
+        int s;
+        char* slot = _checkpoint->beginWrite(s);
+        if(!slot) return;
+        CheckpointSaver saver(slot, _checkpoint->payloadBytes());
+        checkpointState(saver);
+        _checkpoint->commit(s);
+        _lastCheckpoint = std::chrono::steady_clock::now();
+        _checkpoints++;
+    }
+
+    void finishIsland(Island& island)
+    {   // report and copy the island back into _population
+        island.searching = false;
+        if(_snapshots) _snapshots->finish(island.id);
         auto finish = std::chrono::high_resolution_clock::now();
-        THREADPRINT("--thread " << threadID << " ended after " << progressCounter << " iterations, taking "
-                    << std::chrono::duration_cast<std::chrono::milliseconds>(finish-start).count() << "ms\n")
+        GAPRINT("--island " << island.id+1 << " ended after " << island.progressCounter << " iterations, taking "
+                    << std::chrono::duration_cast<std::chrono::milliseconds>(finish-island.start).count() << "ms\n")
+        island.quota.release(); // what this island reserved but will not use goes back to the others
+        _evaluations += island.quota.used();
+        GAPRINT("--island " << island.id+1 << " used " << island.quota.used() << " evaluations\n")
+        if(island.cache) _cacheStats += island.cache->stats();
+        if(_config.convergencePolicy != ConvergencePolicy::none)
+        {
+            const ConvergenceStats& convergence = island.convergenceStats;
+            GAPRINT("--island " << island.id+1 << " ended at a best of " << island.convergence.best() << ", a mean of "
+                        << island.convergence.mean() << " (diversity " << island.convergence.diversity() << "), after "
+                        << convergence.restarts << " restarts and " << convergence.boosts << " boosts"
+                        << (convergence.stopped ? ", stopped on converging\n" : "\n"))
+        }
+        const MigrationStats& migration = _migration.stats(island.id);
+        GAPRINT("--island " << island.id+1 << " sent " << migration.sent << " migrants (" << migration.dropped
+                    << " dropped on full edges) and received " << migration.received << '\n')
+        if(allocation::enabled)
+        {
+            GAPRINT("--island " << island.id+1 << " made " << island.steadyStateAllocations 
+                        << " heap allocations after its first iteration\n")
+        }
 
-        // update the copy of population shared across threads
-        popuLock.lock();
+        // update the copy of population shared across islands
+        std::shared_lock<std::shared_timed_mutex> popuLock{_populationGuard, std::defer_lock};
+        {
+            profile::Wait wait;
+            popuLock.lock();
+        }
         int localCounter=0;
-        for(int i=rangeStart; i<rangeEnd; i++)
+        for(int i=island.rangeStart; i<island.rangeEnd; i++)
         {
-            _population[i] = localPopulation[localCounter];
+            _population[i] = island.population[localCounter];
             localCounter++;
         }
         popuLock.unlock();
+        _running.done();
+    }
+
+    void startIslands()
+    {   // island i evolves _population[i*size/islands : (i+1)*size/islands], so every member is covered
+        // a reproducible run splits what is left of the budget evenly (the first islands take the remainder)
+        // instead of letting the islands race for it
+        const int islands = _config.numberOfThreads;
+        T prototype = _population[0]; // sizes every migration slot up front
+        _migration.build(islands, _config.migrationTopology, _config.migrants, prototype);
+        _islands.clear();
+        const long remaining = _budget.unlimited() ? 0 : _budget.remaining();
+        for(int i=0; i<islands; i++)
+        {
+            int rangeStart = static_cast<long>(i) * _population.size() / islands;
+            int rangeEnd = static_cast<long>(i+1) * _population.size() / islands;
+            _islands.push_back(std::make_unique<Island>(i, rangeStart, rangeEnd, 
+                                                        slice(_population, rangeStart, rangeEnd), _problem, &_budget,
+                                                        Philox(_seed, _nextStream + i)));
+            _islands.back()->convergence = ConvergenceMonitor(_config);
+            if(_config.convergencePolicy == ConvergencePolicy::restart) 
+                _islands.back()->workspace.fresh = _islands.back()->population; // room for the largest restart up front
+            if(_config.reproducible && !_budget.unlimited()) 
+                _islands.back()->quota.allot(remaining / islands + (i < remaining % islands ? 1 : 0));
+        }
+        _nextStream += islands;
 
-        // unlock all locks in case any are still locked
-        if(popuLock) popuLock.unlock();
-        if(sharedPoolLock) sharedPoolLock.unlock();
+        // the fitness cache starts out with the population, so a child bred onto a parent is a hit
+        _cache.reset();
+        if(!caching()) return;
+        const int dimension = populationDimension(_population);
+        if(!_config.reproducible)
+        {   // a shard per 1024 entries, up to 64
+            const int shards = std::min<long>(64, std::max<long>(1, _config.cacheCapacity / 1024));
+            _cache = std::make_unique<FitnessCache>(_config.cacheCapacity, dimension, _config.cacheResolution,
+                                                    _config.cacheEviction, shards);
+        }
+        for(auto& island : _islands)
+        {
+            if(_config.reproducible)
+                island->cache = std::make_unique<FitnessCache>((_config.cacheCapacity + islands - 1) / islands, dimension,
+                                                               _config.cacheResolution, _config.cacheEviction, 1);
+            for(int i=0; i<island->population.size(); i++)
+                cacheOf(*island)->insert(island->population[i], island->population[i].getEval());
+        }
+    }
+
+    void runIslandsInline(bool on = true)
+    {   // run the islands in turn on the calling thread instead of as pool tasks, for when many GAs share
+        // the pool (see batch.hpp); large evaluation batches still spread over the pool
+        _inline = on;
+    }
+
+    void resume(const std::string& path)
+    {   // continue the run checkpointed in path, in place of generateInitialPopulation(); later
+        // checkpoints of this run go to the same file
+        if(!_config.reproducible) throw CheckpointError("resuming needs \"reproducible\": true");
+        _budget.reset(_config.maxEvaluations);
+        _initialQuota = EvaluationQuota(&_budget);
+        _population = _problem.getRandomSolutions(_config.populationSize); // only its shape matters, loaded below
+        startIslands();
+
+        _checkpoint = std::make_unique<CheckpointFile>();
+        size_t payloadBytes;
+        uint64_t sequence;
+        const char* state = _checkpoint->open(path, payloadBytes, sequence);
+        CheckpointMeasurer measurer;
+        checkpointState(measurer);
+        if(measurer.bytes() != payloadBytes) 
+            throw CheckpointError("the checkpoint was written with different parameters or by another build");
+        CheckpointLoader loader(state, payloadBytes);
+        checkpointState(loader);
+
+        int iteration = 0;
+        for(auto& island : _islands)
+        {   // islands that had already finished are copied back, the others continue from their last round
+            island->workspace.reserve(island->population);
+            iteration = std::max(iteration, island->progressCounter);
+            if(island->boosted) boostIsland(*island, true);
+            if(island->searching) continue;
+            for(int i=island->rangeStart; i<island->rangeEnd; i++) 
+                _population[i] = island->population[i - island->rangeStart];
+        }
+        _resumed = true;
+        GAPRINT("--resumed from checkpoint " << sequence << " in " << path << " at iteration " << iteration 
+                << ", seed = " << _seed << '\n')
     }
 
     void optimise()
     {
-        // initialise the multi-threading environment
-        std::vector<std::thread> threadList;
-        std::cout << "--number of available processors = " << std::thread::hardware_concurrency() << '\n';
-        int populationPerThread = _population.size() / _parameters["number of Threads"] - 1;
-
-        // create the optimisation threads
-        for(int i=0; i<_parameters["number of Threads"]; i++)
-        {
-            threadList.push_back(std::thread(
-                        &GA<T>::optimiseThread, 
-                        this,
-                         _parameters["max_iterations"], 
-                         i * populationPerThread, 
-                         std::min<int>((i+1) * populationPerThread, _population.size()))); // starts a thread
-        }
-        
-        for(int i=0; i<threadList.size(); i++) threadList[i].join(); // wait for all threads to complete
-        THREADPRINT("--all threads completed, printing results...\n")
-        clearPrinterQueue(); // print all the data in queue
-        THREADPRINT("--intermediate results saved to " << std::filesystem::current_path().string() << "/Results/\n")
+        // islands run as tasks on the shared pool, whose workers persist across calls
+        _pool = _inline ? nullptr : &ThreadPool::shared(_config.workerThreads);
+        GAPRINT("--number of available processors = " << std::thread::hardware_concurrency() 
+                << ", worker threads = " << (_pool ? _pool->size() : 0) << '\n')
+        const int islands = _config.numberOfThreads;
+        if(!_resumed) startIslands();
+        _resumed = false;
+        _cacheStats = CacheStats();
+        for(auto& island : _islands) if(!island->searching && island->cache) _cacheStats += island->cache->stats();
+        _convergenceStats = ConvergenceStats();
+        for(auto& island : _islands)
+        {
+            island->start = std::chrono::high_resolution_clock::now();
+            if(island->searching)
+                GAPRINT("--island " << island->id+1 << " started handling " << island->population.size() << " solutions\n")
+        }
+
+        // the slots are sized once, the state of a run keeps the same layout throughout
+        _checkpoints = 0;
+        _lastCheckpoint = std::chrono::steady_clock::now();
+        if(_config.checkpointEvery > 0 && !_checkpoint)
+        {
+            CheckpointMeasurer measurer;
+            checkpointState(measurer);
+            _checkpoint = std::make_unique<CheckpointFile>();
+            _checkpoint->create(_config.checkpointFile, measurer.bytes());
+        }
+
+        // snapshots stream to Results/ in the background while the islands run
+        _snapshots.reset();
+        if(_config.printEvery <= _config.maxIterations)
+        {
+            std::vector<std::pair<int, int>> ranges;
+            for(auto& island : _islands) ranges.push_back({island->rangeStart, island->rangeEnd});
+            _snapshots = std::make_unique<SnapshotWriter>("Results", _config.snapshotFormat, _config.snapshotCompression,
+                                                          populationDimension(_population), _population.size(), ranges);
+        }
+        for(auto& island : _islands) if(_snapshots && !island->searching) _snapshots->finish(island->id);
+
+        std::string evaluatorError;
+        if(steadyState()) evaluatorError = runSteadyState();
+        else if(_config.reproducible || !_pool) runLockstep();
+        else
+        {
+            _running.add(islands);
+            for(auto& island : _islands)
+            {
+                Island* start = island.get();
+                _pool->submit([this, start](){ runIsland(*start); });
+            }
+            _pool->wait(_running); // wait for all islands to complete
+        }
+        for(auto& island : _islands) _convergenceStats += island->convergenceStats;
+        _islands.clear();
+        if(_checkpoint)
+        {
+            _checkpoint->wait(); // the last checkpoint is published before optimise() returns
+            GAPRINT("--" << _checkpoints << " checkpoints saved\n")
+        }
+
+        MigrationStats migration = migrationStats();
+        GAPRINT("--migration: " << migration.migrations << " rounds, " << migration.sent << " sent, "
+                    << migration.dropped << " dropped, " << migration.received << " received\n")
+        GAPRINT("--evaluations: " << evaluations() << " used of a budget of " << _budget.limit() << '\n')
+        if(_cache) _cacheStats += _cache->stats();
+        if(caching())
+        {
+            GAPRINT("--fitness cache: " << _cacheStats.hits << " hits, " << _cacheStats.misses << " misses ("
+                        << 100 * _cacheStats.hitRate() << "% hit rate), " << _cacheStats.evictions << " evictions\n")
+        }
+        if(_config.convergencePolicy != ConvergencePolicy::none)
+        {
+            GAPRINT("--convergence: " << _convergenceStats.stopped << " islands stopped, " << _convergenceStats.restarts
+                        << " restarts, " << _convergenceStats.boosts << " boosts, " << _convergenceStats.redistributed 
+                        << " evaluations redistributed\n")
+        }
+        GAPRINT("--all islands completed\n")
+        if(_snapshots)
+        {
+            _snapshots->close(); // writes out whatever is still queued
+            SnapshotStats snapshots = _snapshots->stats();
+            GAPRINT("--" << snapshots.written << " snapshots saved to " << std::filesystem::current_path().string() 
+                        << "/Results/ (" << snapshots.incomplete << " incomplete, " << snapshots.dropped 
+                        << " island shares dropped on a full queue, " << snapshots.failed << " failed)\n")
+            _snapshots.reset();
+        }
+        if(!evaluatorError.empty()) throw EvaluatorError(evaluatorError);
     }
 };
 
+// GA(problemCtx, parameters, config) runs a function-pointer problem through the adapter
+template <typename T, typename Population, typename Parameters>
+GA(ProblemCtx<T, Population, Parameters>, std::remove_const_t<Parameters>, GAConfig)
+    -> GA<ProblemCtxAdapter<T, Population, Parameters>>;
+
 #endif //INCLUDE_GA_CORE
\ No newline at end of file
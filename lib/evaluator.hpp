@@ -0,0 +1,285 @@
+#ifndef INCLUDE_GA_EVALUATOR
+#define INCLUDE_GA_EVALUATOR
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <stdexcept>
+#include <cstdint>
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "threadpool.hpp"
+
+/* Asynchronous evaluation for "steady state" runs (see runSteadyState in core.hpp): the GA queues
+   candidates on an EvaluationPipeline as it breeds them and collects each one as soon as its
+   evaluation finished, whatever order they finish in. At most the pipeline's limit ("max in
+   flight") are queued or being evaluated at a time, in slots allocated up front.
+
+   Candidates are evaluated in process, by the problem's evaluateSolution as tasks on the pool (or
+   right away on the calling thread without one), or with "evaluator" set by worker processes: the
+   command is run "evaluator processes" times through /bin/sh, each connected by a Unix socket on its
+   stdin and stdout and served by a thread of its own, so a simulation of seconds only ever blocks
+   that thread. The protocol is binary and native endian:
+
+       GA -> worker   int32 dimension, once at the start
+       GA -> worker   float32 x[dimension], per candidate
+       worker -> GA   float32 objective, per candidate, in order
+
+   A worker exits when its stdin closes. A worker that exits early or breaks the protocol fails
+   the run with an EvaluatorError once what is in flight has been collected. */
+
+class EvaluatorError : public std::runtime_error
+{
+public:
+    explicit EvaluatorError(const std::string& what) : std::runtime_error(what) {}
+};
+
+class WorkerProcess
+{   // one evaluator process, evaluate() is only ever called by one thread at a time
+private:
+    std::string _command;
+    int _dimension;
+    pid_t _pid = -1;
+    int _socket = -1;
+
+    void writeAll(const void* data, size_t bytes)
+    {   // MSG_NOSIGNAL: a worker that died is an error here, not a SIGPIPE
+        const char* p = static_cast<const char*>(data);
+        while(bytes > 0)
+        {
+            ssize_t n = send(_socket, p, bytes, MSG_NOSIGNAL);
+            if(n < 0 && errno == EINTR) continue;
+            if(n <= 0) throw EvaluatorError("cannot write to evaluator \"" + _command + "\": " + std::strerror(errno));
+            p += n;
+            bytes -= n;
+        }
+    }
+
+    void readAll(void* data, size_t bytes)
+    {
+        char* p = static_cast<char*>(data);
+        while(bytes > 0)
+        {
+            ssize_t n = recv(_socket, p, bytes, 0);
+            if(n < 0 && errno == EINTR) continue;
+            if(n == 0) throw EvaluatorError("evaluator \"" + _command + "\" exited");
+            if(n < 0) throw EvaluatorError("cannot read from evaluator \"" + _command + "\": " + std::strerror(errno));
+            p += n;
+            bytes -= n;
+        }
+    }
+
+public:
+    WorkerProcess(const std::string& command, int dimension) : _command(command), _dimension(dimension)
+    {   // both ends close on exec, so no worker inherits the connection of another
+        int ends[2];
+        if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, ends) != 0)
+            throw EvaluatorError(std::string("cannot create a socket for the evaluator: ") + std::strerror(errno));
+        _pid = fork();
+        if(_pid < 0)
+        {
+            close(ends[0]);
+            close(ends[1]);
+            throw EvaluatorError(std::string("cannot start the evaluator: ") + std::strerror(errno));
+        }
+        if(_pid == 0)
+        {   // the worker: the socket as stdin and stdout (dup2 clears close on exec), only
+            // async-signal-safe calls until exec
+            dup2(ends[1], STDIN_FILENO);
+            dup2(ends[1], STDOUT_FILENO);
+            execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        close(ends[1]);
+        _socket = ends[0];
+        const int32_t header = dimension;
+        writeAll(&header, sizeof(header));
+    }
+
+    WorkerProcess(const WorkerProcess&) = delete;
+    WorkerProcess& operator=(const WorkerProcess&) = delete;
+
+    ~WorkerProcess()
+    {   // closing the socket tells the worker to exit, one that has not after a second is killed
+        if(_socket >= 0) close(_socket);
+        if(_pid <= 0) return;
+        for(int i=0; i<100; i++)
+        {
+            if(waitpid(_pid, nullptr, WNOHANG) != 0) return;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        kill(_pid, SIGKILL);
+        waitpid(_pid, nullptr, 0);
+    }
+
+    float evaluate(const float* x)
+    {   // the objective of one candidate, blocks until the worker answered
+        writeAll(x, sizeof(float) * _dimension);
+        float f;
+        readAll(&f, sizeof(f));
+        return f;
+    }
+};
+
+template <typename T>
+class EvaluationPipeline
+{   // only the thread that submits and collects (the GA's) calls the public members
+public:
+    struct Request
+    {
+        int island;
+        T solution;
+        bool failed;
+    };
+
+private:
+    std::vector<Request> _slots;
+    std::vector<int> _free;         // slots not in flight
+    std::vector<int> _ready;        // slots collect() is handing back
+    std::mutex _guard;
+    std::condition_variable _completion;
+    std::condition_variable _queued;
+    std::deque<int> _requests;      // waiting for a worker process
+    std::vector<int> _completed;    // evaluated, not yet collected
+    std::string _error;             // the first failure
+    bool _stop = false;
+    std::vector<std::unique_ptr<WorkerProcess>> _processes;
+    std::vector<std::thread> _servers;
+    std::function<void(T&)> _evaluate;
+    ThreadPool* _pool;
+    int _dimension;
+
+    void complete(int k)
+    {
+        std::lock_guard<std::mutex> lock(_guard);
+        _completed.push_back(k);
+        _completion.notify_one();
+    }
+
+    void evaluateInProcess(int k)
+    {
+        Request& request = _slots[k];
+        request.failed = false;
+        _evaluate(request.solution);
+        complete(k);
+    }
+
+    void serve(WorkerProcess& process)
+    {   // a worker process's thread: its requests in the order they were queued
+        std::vector<float> x(_dimension);
+        while(true)
+        {
+            int k;
+            {
+                std::unique_lock<std::mutex> lock(_guard);
+                _queued.wait(lock, [&]{ return _stop || !_requests.empty(); });
+                if(_requests.empty()) return;
+                k = _requests.front();
+                _requests.pop_front();
+            }
+            Request& request = _slots[k];
+            request.failed = false;
+            try
+            {
+                for(int d=0; d<_dimension; d++) x[d] = request.solution.getX(d);
+                request.solution.setEval(process.evaluate(x.data()));
+            }catch(const EvaluatorError& e)
+            {
+                request.failed = true;
+                std::lock_guard<std::mutex> lock(_guard);
+                if(_error.empty()) _error = e.what();
+            }
+            complete(k);
+        }
+    }
+
+public:
+    EvaluationPipeline(int limit, const T& prototype, std::function<void(T&)> evaluate, ThreadPool* pool,
+                       const std::string& command, int processes)
+        : _evaluate(std::move(evaluate)), _pool(pool), _dimension(prototype.dimension())
+    {   // with a command, processes worker processes evaluate; without, evaluate does on the pool
+        _slots.assign(limit, Request{-1, prototype, false});
+        for(int k=limit-1; k>=0; k--) _free.push_back(k);
+        _ready.reserve(limit);
+        _completed.reserve(limit);
+        if(command.empty()) return;
+        for(int i=0; i<processes; i++) _processes.push_back(std::make_unique<WorkerProcess>(command, _dimension));
+        for(auto& process : _processes)
+        {
+            WorkerProcess* served = process.get();
+            _servers.emplace_back([this, served](){ serve(*served); });
+        }
+    }
+
+    EvaluationPipeline(const EvaluationPipeline&) = delete;
+    EvaluationPipeline& operator=(const EvaluationPipeline&) = delete;
+
+    ~EvaluationPipeline()
+    {   // only once everything in flight was collected
+        {
+            std::lock_guard<std::mutex> lock(_guard);
+            _stop = true;
+        }
+        _queued.notify_all();
+        for(std::thread& server : _servers) server.join();
+    }
+
+    bool full() const { return _free.empty(); }
+
+    int inFlight() const { return _slots.size() - _free.size(); }
+
+    std::string error()
+    {
+        std::lock_guard<std::mutex> lock(_guard);
+        return _error;
+    }
+
+    template <typename S>
+    void submit(int island, const S& candidate)
+    {   // queue candidate (a solution or SoA member) of island, only while !full()
+        const int k = _free.back();
+        _free.pop_back();
+        _slots[k].island = island;
+        _slots[k].solution = candidate;
+        if(!_processes.empty())
+        {
+            {
+                std::lock_guard<std::mutex> lock(_guard);
+                _requests.push_back(k);
+            }
+            _queued.notify_one();
+        }else if(_pool) _pool->submit([this, k](){ evaluateInProcess(k); });
+        else evaluateInProcess(k);
+    }
+
+    template <typename F>
+    int collect(F&& arrived, bool wait)
+    {   // arrived(request) for every evaluation that finished, blocking until one has when wait is set.
+        // Returns how many there were
+        {
+            std::unique_lock<std::mutex> lock(_guard);
+            if(wait) _completion.wait(lock, [&]{ return !_completed.empty(); });
+            _ready.swap(_completed);
+        }
+        for(int k : _ready)
+        {
+            arrived(_slots[k]);
+            _free.push_back(k);
+        }
+        const int n = _ready.size();
+        _ready.clear();
+        return n;
+    }
+};
+
+#endif // INCLUDE_GA_EVALUATOR
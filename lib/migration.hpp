@@ -0,0 +1,254 @@
+#ifndef INCLUDE_GA_MIGRATION
+#define INCLUDE_GA_MIGRATION
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include "config.hpp"
+
+/* Island migration without locks. Every directed edge of the topology owns a bounded single
+   producer / single consumer ring, so the only shared state two islands touch is the head and tail
+   counters of the edges between them. Ring slots are constructed from a prototype solution before
+   the islands start and are only ever assigned into afterwards, so migration does not allocate.
+
+   ring             island i sends to i+1
+   torus            islands on the most square grid rows x cols, each sending to its 4 neighbours
+   fully connected  every island sends to every other island
+   random           every island can reach every other, but each migration sends to one of them at random
+
+   An island that finds an edge full drops the migrant (counted in MigrationStats) rather than wait. */
+
+template <typename T>
+class SpscQueue
+{   // bounded lock-free queue between one producer and one consumer thread
+private:
+    std::vector<T> _slots;
+    size_t _mask;
+    alignas(64) std::atomic<size_t> _head; // next slot to pop, written by the consumer
+    alignas(64) std::atomic<size_t> _tail; // next slot to push, written by the producer
+
+public:
+    SpscQueue(int capacity, const T& prototype) : _head(0), _tail(0)
+    {   // capacity is rounded up to a power of two
+        size_t size = 1;
+        while(size < static_cast<size_t>(capacity)) size *= 2;
+        _slots.assign(size, prototype);
+        _mask = size - 1;
+    }
+
+    bool tryPush(const T& value)
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if(tail - _head.load(std::memory_order_acquire) > _mask) return false; // full
+        _slots[tail & _mask] = value;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename F>
+    bool tryPushWith(F&& write)
+    {   // like tryPush, but write(slot) fills the free slot in place
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if(tail - _head.load(std::memory_order_acquire) > _mask) return false; // full
+        write(_slots[tail & _mask]);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename Archive, typename F>
+    void checkpoint(Archive& archive, F&& item)
+    {   // only while neither side is running: the queued count, then every slot from the head on (so
+        // the layout does not depend on how full the queue is), item(archive, slot) stores one
+        size_t head = _head.load();
+        size_t count = _tail.load() - head;
+        archive.io(count);
+        if(!Archive::saving)
+        {
+            head = 0;
+            _head.store(0);
+            _tail.store(count);
+        }
+        for(size_t k=0; k<_slots.size(); k++) item(archive, _slots[(head + k) & _mask]);
+    }
+
+    bool tryPop(T& value)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if(head == _tail.load(std::memory_order_acquire)) return false; // empty
+        value = _slots[head & _mask];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+struct MigrationStats
+{
+    long migrations = 0; // migration rounds
+    long sent = 0;       // solutions pushed onto an edge
+    long dropped = 0;    // solutions not sent because the edge was full
+    long received = 0;   // solutions taken into the population
+
+    MigrationStats& operator+=(const MigrationStats& other)
+    {
+        migrations += other.migrations;
+        sent += other.sent;
+        dropped += other.dropped;
+        received += other.received;
+        return *this;
+    }
+};
+
+std::vector<std::vector<int>> topologyNeighbours(int islands, MigrationTopology topology)
+{   // the islands each island sends to, in edge order (also the processes a cluster relays between, see
+    // cluster.hpp). Random and fully connected share the edges, they differ in how many a round uses
+    std::vector<std::vector<int>> out(islands);
+    auto connect = [&](int from, int to)
+    {   // torus neighbours can coincide
+        if(from != to && std::find(out[from].begin(), out[from].end(), to) == out[from].end()) out[from].push_back(to);
+    };
+    switch(topology)
+    {
+        case MigrationTopology::ring:
+            for(int i=0; i<islands; i++) connect(i, (i+1) % islands);
+            break;
+        case MigrationTopology::torus:
+        {
+            int rows = std::sqrt(islands);
+            while(islands % rows != 0) rows -= 1;
+            int cols = islands / rows;
+            for(int i=0; i<islands; i++)
+            {
+                int r = i / cols;
+                int c = i % cols;
+                connect(i, r * cols + (c+1) % cols);
+                connect(i, ((r+1) % rows) * cols + c);
+                connect(i, r * cols + (c+cols-1) % cols);
+                connect(i, ((r+rows-1) % rows) * cols + c);
+            }
+            break;
+        }
+        case MigrationTopology::fullyConnected:
+        case MigrationTopology::random:
+            for(int i=0; i<islands; i++)
+            {
+                for(int j=0; j<islands; j++) connect(i, j);
+            }
+            break;
+    }
+    return out;
+}
+
+template <typename T>
+class MigrationNetwork
+{
+private:
+    struct Edge
+    {
+        int from;
+        int to;
+        std::unique_ptr<SpscQueue<T>> queue;
+    };
+
+    struct alignas(64) Island
+    {   // only ever touched by the island's own thread
+        std::vector<int> out;  // edges leaving this island
+        std::vector<int> in;   // edges arriving at it
+        int target = -1;       // random topology: the one out edge used this round
+        int nextIn = 0;        // round robin over in edges when receiving
+        MigrationStats stats;
+    };
+
+    MigrationTopology _topology = MigrationTopology::random;
+    std::vector<Edge> _edges;
+    std::vector<Island> _islands;
+
+    void connect(int from, int to, int capacity, const T& prototype)
+    {
+        _islands[from].out.push_back(_edges.size());
+        _islands[to].in.push_back(_edges.size());
+        _edges.push_back(Edge{from, to, std::make_unique<SpscQueue<T>>(capacity, prototype)});
+    }
+
+public:
+    void build(int islands, MigrationTopology topology, int migrants, const T& prototype)
+    {   // called before the islands start, each edge holds two rounds of migrants
+        _topology = topology;
+        _edges.clear();
+        _islands.assign(islands, Island());
+        const int capacity = 2 * migrants;
+        std::vector<std::vector<int>> neighbours = topologyNeighbours(islands, topology);
+        for(int i=0; i<islands; i++)
+        {
+            for(int j : neighbours[i]) connect(i, j, capacity, prototype);
+        }
+    }
+
+    int inDegree(int island) const { return _islands[island].in.size(); }
+
+    template <typename Gen>
+    void beginRound(int island, Gen& gen)
+    {   // start a migration round of island, picking its target under the random topology
+        Island& self = _islands[island];
+        self.stats.migrations += 1;
+        if(_topology == MigrationTopology::random && !self.out.empty())
+        {
+            self.target = self.out[std::uniform_int_distribution<int>(0, self.out.size()-1)(gen)];
+        }
+    }
+
+    void send(int island, const T& migrant)
+    {   // push a copy of migrant onto the island's outgoing edge(s) for this round
+        Island& self = _islands[island];
+        auto push = [&](int e)
+        {
+            if(_edges[e].queue->tryPush(migrant)) self.stats.sent += 1;
+            else self.stats.dropped += 1;
+        };
+        if(_topology == MigrationTopology::random)
+        {
+            if(self.target >= 0) push(self.target);
+        }else for(int e : self.out) push(e);
+    }
+
+    bool receive(int island, T& migrant)
+    {   // pop the next waiting migrant, visiting the incoming edges in turn
+        Island& self = _islands[island];
+        for(int k=0; k<self.in.size(); k++)
+        {
+            int e = self.in[self.nextIn];
+            self.nextIn = (self.nextIn + 1) % self.in.size();
+            if(_edges[e].queue->tryPop(migrant))
+            {
+                self.stats.received += 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const MigrationStats& stats(int island) const { return _islands[island].stats; }
+
+    template <typename Archive, typename F>
+    void checkpoint(Archive& archive, F&& item)
+    {   // the queued migrants and every island's round state, only while no island is running
+        for(Island& island : _islands)
+        {
+            archive.io(island.target);
+            archive.io(island.nextIn);
+            archive.io(island.stats);
+        }
+        for(Edge& edge : _edges) edge.queue->checkpoint(archive, item);
+    }
+
+    MigrationStats totalStats() const
+    {   // only meaningful once the islands have stopped
+        MigrationStats total;
+        for(const Island& island : _islands) total += island.stats;
+        return total;
+    }
+};
+
+#endif // INCLUDE_GA_MIGRATION
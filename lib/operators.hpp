@@ -0,0 +1,215 @@
+#ifndef INCLUDE_GA_OPERATORS
+#define INCLUDE_GA_OPERATORS
+
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include "config.hpp"
+#include "random.hpp"
+#include "profile.hpp"
+
+/* Variation operators: how a child's coordinates are drawn from its two parents, and how a draw that
+   falls outside [lower, upper] is brought back in. Every operator makes a fixed number of draws per
+   coordinate, at most one more when the first lands outside the bounds, so a child costs the same
+   wherever its parents lie and whatever the breeding scale; nothing is ever redrawn in a loop.
+
+   crossover
+     normal   x ~ N(parent1, scale * ||parent1 - parent2||_2) in every coordinate
+     blend    BLX-alpha, x uniform on [lo - alpha*d, hi + alpha*d] where lo and hi are the parents'
+              coordinates and d = hi - lo
+
+   boundary handling
+     truncate  the draw's distribution restricted to the bounds: a normal draw outside them is replaced
+               by the inverse cdf of one uniform draw over the cdf range the bounds cover (together,
+               exactly the truncated normal), a blend draw is made on the interval's part inside the
+               bounds in the first place. The same distribution as redrawing until inside
+     reflect   mirrored back at the bound it crossed, folding again if it crosses the other
+     clamp     moved onto the bound it crossed
+
+   Repaired coordinates count as "boundary repairs" in a GA_PROFILE build (see profile.hpp). */
+
+enum class Crossover { normal, blend };
+
+enum class BoundaryHandling { truncate, reflect, clamp };
+
+Crossover parseCrossover(const std::string& name)
+{
+    if(name == "normal") return Crossover::normal;
+    if(name == "blend") return Crossover::blend;
+    throw ConfigError("unknown crossover \"" + name + "\" (normal or blend)");
+}
+
+BoundaryHandling parseBoundaryHandling(const std::string& name)
+{
+    if(name == "truncate") return BoundaryHandling::truncate;
+    if(name == "reflect") return BoundaryHandling::reflect;
+    if(name == "clamp") return BoundaryHandling::clamp;
+    throw ConfigError("unknown boundary handling \"" + name + "\" (truncate, reflect or clamp)");
+}
+
+namespace operators
+{
+    inline double normalCdf(double x)
+    {
+        return 0.5 * std::erfc(-x * M_SQRT1_2);
+    }
+
+    inline double normalQuantile(double p)
+    {   // inverse of normalCdf for 0 < p < 1, Acklam's rational approximation (relative error < 1.2e-9)
+        static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                   1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+        static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                   6.680131188771972e+01, -1.328068155288572e+01};
+        static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                   -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+        static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                   3.754408661907416e+00};
+        const double low = 0.02425;
+        if(p < low)
+        {
+            const double q = std::sqrt(-2 * std::log(p));
+            return (((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5]) /
+                   ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1);
+        }
+        if(p > 1 - low)
+        {
+            const double q = std::sqrt(-2 * std::log1p(-p));
+            return -(((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5]) /
+                    ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1);
+        }
+        const double q = p - 0.5;
+        const double r = q * q;
+        return (((((a[0]*r + a[1])*r + a[2])*r + a[3])*r + a[4])*r + a[5]) * q /
+               (((((b[0]*r + b[1])*r + b[2])*r + b[3])*r + b[4])*r + 1);
+    }
+
+    inline float truncatedNormal(float mean, float sd, float lower, float upper, float u)
+    {   // N(mean, sd) restricted to [lower, upper] from one u uniform in [0, 1). Worked in the lower tail
+        // (an interval above the mean is mirrored), where the cdf keeps its precision
+        if(!(sd > 0)) return std::min(std::max(mean, lower), upper);
+        double alpha = (lower - mean) / static_cast<double>(sd);
+        double beta = (upper - mean) / static_cast<double>(sd);
+        const bool mirrored = alpha > 0;
+        if(mirrored)
+        {
+            const double t = alpha;
+            alpha = -beta;
+            beta = -t;
+        }
+        const double lo = normalCdf(alpha);
+        const double hi = normalCdf(beta);
+        const double p = std::min(std::max(lo + u * (hi - lo), 1e-300), std::nextafter(1.0, 0.0));
+        const double z = normalQuantile(p);
+        const float x = mean + sd * static_cast<float>(mirrored ? -z : z);
+        return std::min(std::max(x, lower), upper); // against rounding at the bounds
+    }
+
+    inline float reflect(float x, float lower, float upper)
+    {   // x folded back into [lower, upper] at its bounds
+        const float width = upper - lower;
+        float y = std::fmod(x - lower, 2 * width);
+        if(y < 0) y += 2 * width;
+        return std::min(y <= width ? lower + y : upper - (y - width), upper);
+    }
+
+    inline float clamp(float x, float lower, float upper)
+    {
+        return std::min(std::max(x, lower), upper);
+    }
+}
+
+class Breeder
+{   // breeds children under one crossover and boundary handling, drawing from a stream in bulk. The
+    // draws left over when it goes out of scope are discarded
+private:
+    static constexpr int chunk = 64; // draws made in bulk at a time
+    Crossover _crossover;
+    BoundaryHandling _boundary;
+    float _scale;
+    float _alpha;
+    float _lower;
+    float _upper;
+    Philox& _gen;
+    float _normals[chunk];
+    float _uniforms[chunk];
+    int _nextNormal = chunk;
+    int _nextUniform = chunk;
+
+    float normal()
+    {
+        if(_nextNormal == chunk)
+        {
+            _gen.fillNormal(_normals, chunk);
+            _nextNormal = 0;
+        }
+        return _normals[_nextNormal++];
+    }
+
+    float uniform()
+    {   // in [0, 1)
+        if(_nextUniform == chunk)
+        {
+            _gen.fillUniform(_uniforms, chunk, 0, 1);
+            _nextUniform = 0;
+        }
+        return _uniforms[_nextUniform++];
+    }
+
+    float repair(float x)
+    {   // reflect or clamp a draw that left the bounds
+        profile::count(profile::Counter::boundaryRepairs);
+        return _boundary == BoundaryHandling::reflect ? operators::reflect(x, _lower, _upper)
+                                                      : operators::clamp(x, _lower, _upper);
+    }
+
+    float normalCoordinate(float mean, float sd)
+    {
+        const float x = mean + sd * normal();
+        if((x <= _upper) & (x >= _lower)) return x;
+        if(_boundary != BoundaryHandling::truncate) return repair(x);
+        profile::count(profile::Counter::boundaryRepairs);
+        return operators::truncatedNormal(mean, sd, _lower, _upper, uniform());
+    }
+
+    float blendCoordinate(float x1, float x2)
+    {
+        const float spread = _alpha * std::fabs(x1 - x2);
+        float lo = std::min(x1, x2) - spread;
+        float hi = std::max(x1, x2) + spread;
+        if(_boundary == BoundaryHandling::truncate)
+        {   // drawn inside the bounds in the first place
+            lo = std::max(lo, _lower);
+            hi = std::min(hi, _upper);
+            return std::min(lo + (hi - lo) * uniform(), hi);
+        }
+        const float x = lo + (hi - lo) * uniform();
+        return (x <= _upper) & (x >= _lower) ? x : repair(x);
+    }
+
+public:
+    Breeder(Crossover crossover, BoundaryHandling boundary, float scale, float alpha, float lower, float upper,
+            Philox& generator)
+        : _crossover(crossover), _boundary(boundary), _scale(scale), _alpha(alpha), _lower(lower), _upper(upper),
+          _gen(generator) {}
+
+    template <typename P1, typename P2, typename C>
+    void breed(const P1& parent1, const P2& parent2, C&& child, int dimension)
+    {   // child's coordinates from the two parents (solutions or SoA members), its fitness is left to
+        // the caller's batch evaluation
+        if(_crossover == Crossover::blend)
+        {
+            for(int d=0; d<dimension; d++) child.setX(d, blendCoordinate(parent1.getX(d), parent2.getX(d)));
+            return;
+        }
+        float squared = 0;
+        for(int d=0; d<dimension; d++)
+        {
+            const float diff = parent1.getX(d) - parent2.getX(d);
+            squared += diff * diff;
+        }
+        const float sd = _scale * std::sqrt(squared);
+        for(int d=0; d<dimension; d++) child.setX(d, normalCoordinate(parent1.getX(d), sd));
+    }
+};
+
+#endif // INCLUDE_GA_OPERATORS
@@ -0,0 +1,170 @@
+#ifndef INCLUDE_GA_POPULATION
+#define INCLUDE_GA_POPULATION
+
+#include <vector>
+#include <ostream>
+#include <algorithm>
+#include <cassert>
+
+/* Population containers the GA core can run over.
+
+   The reference layout is a plain std::vector<T> (array of structs), where every solution carries
+   its own coordinates, objective and constraints. SoAPopulation<T> stores the same information as a
+   structure of arrays: one contiguous column per dimension, a separate fitness column and a single
+   copy of the constraints shared by every member. Both are indexed with population[i] and expose
+   getEval(), getX(d), setX(d, val) on the element, so problem methods can be written once as
+   templates over the population type.
+
+   T must provide: a constructor taking the dimension, dimension(), getX(int), setX(int, float),
+   getEval(), setEval(float), getLowerBound(), getUpperBound() and setBounds(float, float). */
+
+template <typename T>
+class SoAPopulation
+{
+private:
+    int _dimension;
+    int _size;
+    int _capacity;
+    std::vector<float> _x; // _dimension columns of _capacity floats each
+    std::vector<float> _f;
+    float _lbound; // constraints shared by every member
+    float _ubound;
+
+    void grow(int capacity)
+    {   // re-layout the columns for a bigger capacity, keeping the current members
+        std::vector<float> x(static_cast<size_t>(_dimension) * capacity);
+        for(int d=0; d<_dimension; d++)
+        {
+            std::copy(_x.begin() + static_cast<size_t>(d) * _capacity,
+                      _x.begin() + static_cast<size_t>(d) * _capacity + _size,
+                      x.begin() + static_cast<size_t>(d) * capacity);
+        }
+        _x.swap(x);
+        _f.resize(capacity);
+        _capacity = capacity;
+    }
+
+public:
+    typedef T value_type;
+
+    class Ref
+    {   // proxy for population[i], assignment copies the member's values (it never rebinds)
+    private:
+        SoAPopulation* _p;
+        int _i;
+
+    public:
+        Ref(SoAPopulation* p, int i) : _p(p), _i(i) {}
+
+        float getEval() const { return _p->_f[_i]; }
+        void setEval(float val) { _p->_f[_i] = val; }
+        float getX(int d) const { return _p->_x[static_cast<size_t>(d) * _p->_capacity + _i]; }
+        void setX(int d, float val) { _p->_x[static_cast<size_t>(d) * _p->_capacity + _i] = val; }
+
+        Ref& operator=(const T& s)
+        {
+            for(int d=0; d<_p->_dimension; d++) setX(d, s.getX(d));
+            setEval(s.getEval());
+            return *this;
+        }
+
+        Ref& operator=(const Ref& other)
+        {
+            for(int d=0; d<_p->_dimension; d++) setX(d, other.getX(d));
+            setEval(other.getEval());
+            return *this;
+        }
+
+        operator T() const
+        {   // materialise an array-of-structs copy of this member
+            T s(_p->_dimension);
+            s.setBounds(_p->_lbound, _p->_ubound);
+            for(int d=0; d<_p->_dimension; d++) s.setX(d, getX(d));
+            s.setEval(getEval());
+            return s;
+        }
+
+        friend std::ostream& operator<< (std::ostream& stream, const Ref& r)
+        {
+            return stream << static_cast<T>(r);
+        }
+    };
+
+    SoAPopulation(int dimension = 0, float lowerbound = 0, float upperbound = 0, int size = 0)
+        : _dimension(dimension), _size(0), _capacity(0), _lbound(lowerbound), _ubound(upperbound)
+    {
+        resize(size);
+    }
+
+    int size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    int capacity() const { return _capacity; }
+    int dimension() const { return _dimension; }
+    float getLowerBound() const { return _lbound; }
+    float getUpperBound() const { return _ubound; }
+
+    float* column(int d) { return _x.data() + static_cast<size_t>(d) * _capacity; }
+    const float* column(int d) const { return _x.data() + static_cast<size_t>(d) * _capacity; }
+    float* fitness() { return _f.data(); }
+    const float* fitness() const { return _f.data(); }
+
+    void reserve(int capacity)
+    {
+        if(capacity > _capacity) grow(capacity);
+    }
+
+    void resize(int size)
+    {   // new members are zero initialised
+        reserve(size);
+        for(int d=0; d<_dimension; d++) std::fill(column(d) + std::min(_size, size), column(d) + size, 0.0f);
+        std::fill(_f.begin() + std::min(_size, size), _f.begin() + size, 0.0f);
+        _size = size;
+    }
+
+    void clear() { _size = 0; }
+
+    void push_back(const T& s)
+    {
+        if(_size == _capacity) grow(std::max(16, 2 * _capacity));
+        _size += 1;
+        (*this)[_size-1] = s;
+    }
+
+    Ref operator[](int i) { assert(i >= 0 && i < _size); return Ref(this, i); }
+    Ref operator[](int i) const { assert(i >= 0 && i < _size); return Ref(const_cast<SoAPopulation*>(this), i); }
+};
+
+// copy population[rangeStart:rangeEnd] into a new container of the same layout
+template <typename T>
+std::vector<T> slice(const std::vector<T>& population, int rangeStart, int rangeEnd)
+{
+    return std::vector<T>(population.begin() + rangeStart, population.begin() + rangeEnd);
+}
+
+template <typename T>
+SoAPopulation<T> slice(const SoAPopulation<T>& population, int rangeStart, int rangeEnd)
+{
+    SoAPopulation<T> s(population.dimension(), population.getLowerBound(), population.getUpperBound(),
+                       rangeEnd - rangeStart);
+    for(int d=0; d<population.dimension(); d++)
+    {
+        std::copy(population.column(d) + rangeStart, population.column(d) + rangeEnd, s.column(d));
+    }
+    std::copy(population.fitness() + rangeStart, population.fitness() + rangeEnd, s.fitness());
+    return s;
+}
+
+// number of coordinates of the population's members (0 for an empty array of structs)
+template <typename T>
+int populationDimension(const std::vector<T>& population)
+{
+    return population.empty() ? 0 : population[0].dimension();
+}
+
+template <typename T>
+int populationDimension(const SoAPopulation<T>& population)
+{
+    return population.dimension();
+}
+
+#endif // INCLUDE_GA_POPULATION
@@ -0,0 +1,219 @@
+#ifndef INCLUDE_GA_PROBLEM
+#define INCLUDE_GA_PROBLEM
+
+#include <vector>
+#include <string>
+#include <random>
+#include <utility>
+#include <type_traits>
+#include <unordered_map>
+#include "ranking.hpp"
+#include "budget.hpp"
+#include "random.hpp"
+#include "cache.hpp"
+
+/* The problem interface GA<Problem> is specialised on. Every stage is an ordinary member call, so
+   the compiler sees the problem's code at the call site and can inline it; the problem keeps
+   whatever parameters it needs itself instead of receiving them on every call.
+
+   struct Problem
+   {
+       typedef ... solution_type;    // a single solution, eg. Schwefel::soln<6>
+       typedef ... population_type;  // std::vector<solution_type> or SoAPopulation<solution_type>
+
+       void setRandomGenerator(Philox*);
+       void setEvaluationQuota(EvaluationQuota*);
+       population_type getRandomSolutions(int size);
+       void getParentIdx(population_type&, int rangeStart, int rangeEnd,
+                         std::vector<int>& parentIdx, Ranking& ranking);
+       void getChildren(population_type&, std::vector<int>& parentIdx, population_type& children);
+       void updatePopulation(population_type&, population_type& children, Ranking& ranking);
+       bool endSearch();
+   };
+
+   The stages write their results into the output arguments, which the GA keeps in a per-thread
+   Workspace and hands back every generation; overwriting them in place (clear/resize, never
+   shrink_to_fit) lets steady-state generations run without touching the heap.
+
+   The GA owns the evaluation budget (see budget.hpp). Before a thread runs a stage it hands the
+   problem the quota to charge, and the problem asks it for permission before evaluating anything,
+   evaluating only as many solutions as it is granted.
+
+   Randomness comes from counter-based streams (see random.hpp) owned by the GA, one per island
+   (and one for the initial population), all derived from the run's "seed". Before a thread runs a
+   stage it hands the problem the stream to draw from; the problem must draw only from that one for
+   the run to be reproducible.
+
+   The ranking (see ranking.hpp) also persists across generations: getParentIdx rebuilds it only
+   when it is empty or does not cover the population, updatePopulation must re-rank the members it
+   replaces, and the GA itself keeps it current when migration swaps a member.
+
+   A problem may also define void setFitnessCache(FitnessCache*): with "cache capacity" set, the GA
+   lends it the cache to use (see cache.hpp) the same way, and the problem looks every solution up
+   before evaluating it, charges the quota only for the misses and caches what it evaluates.
+
+   For "steady state" runs (see core.hpp) a problem defines two more members,
+
+       void breedChildren(population_type&, std::vector<int>& parentIdx, population_type& children);
+       void evaluateSolution(solution_type&) const;
+
+   breedChildren is getChildren without the evaluation: the children are left unevaluated and nothing
+   is charged. The GA charges the quota for each child itself and evaluates them one at a time with
+   evaluateSolution, concurrently on the pool, so it must be safe to call from several threads at once.
+
+   A problem may also define void setMutationScale(float): with "convergence policy": "boost", the GA
+   scales the mutation of an island's children by "boost factor" through it while the island is
+   boosted, and sets it back to 1 once the island improves (see convergence.hpp).
+
+   And void getRandomSolutions(int size, population_type& solutions), which overwrites solutions in
+   place with size evaluated random solutions and charges nothing: with "convergence policy":
+   "restart", the GA charges the quota itself and draws the replacements into a buffer it keeps in
+   the island's Workspace, instead of into a new population on every restart.
+
+   Each optimisation thread works on its own copy of the problem, so it must be copyable. Problems
+   written against the older ProblemCtx function-pointer table run through ProblemCtxAdapter. */
+
+// problem specific methods (to be defined for each optimisation problem)
+// Population is the container the methods run over: std::vector<T> (array of structs, the reference
+// layout) or SoAPopulation<T> (structure of arrays), see population.hpp
+// Parameters is what every method receives, eg. a problem's typed config (possibly const)
+template <typename T, typename Population = std::vector<T>,
+          typename Parameters = std::unordered_map<std::string, float>>
+struct ProblemCtx
+{
+    void (*setRandomGenerator)(Philox*);
+    void (*setEvaluationQuota)(EvaluationQuota*);
+    Population (*getRandomSolutions)(int, Parameters&);
+    std::pair<std::vector<int>, std::vector<std::pair<float, int>>>
+        (*getParentIdx)(Population&, int, int, Parameters&);
+    Population (*getChildren)(Population&, std::vector<int>&, Parameters&);
+    void (*updatePopulation)(Population&, Population&, std::vector<std::pair<float, int>>, Parameters&);
+    bool (*endSearch)(Parameters&);
+};
+
+template <typename T, typename Population = std::vector<T>,
+          typename Parameters = std::unordered_map<std::string, float>>
+class ProblemCtxAdapter
+{   // runs a ProblemCtx through the Problem interface, every stage stays an indirect call
+private:
+    ProblemCtx<T, Population, Parameters> _ctx;
+    std::remove_const_t<Parameters> _parameters;
+
+public:
+    typedef T solution_type;
+    typedef Population population_type;
+
+    ProblemCtxAdapter(ProblemCtx<T, Population, Parameters> ctx, std::remove_const_t<Parameters> parameters)
+        : _ctx(ctx), _parameters(parameters) {}
+
+    void setRandomGenerator(Philox* gen) { _ctx.setRandomGenerator(gen); }
+
+    void setEvaluationQuota(EvaluationQuota* quota) { _ctx.setEvaluationQuota(quota); }
+
+    Population getRandomSolutions(int size) { return _ctx.getRandomSolutions(size, _parameters); }
+
+    void getParentIdx(Population& population, int rangeStart, int rangeEnd,
+                      std::vector<int>& parentIdx, Ranking& ranking)
+    {   // a ProblemCtx sorts from scratch every generation, its result replaces the ranking
+        auto result = _ctx.getParentIdx(population, rangeStart, rangeEnd, _parameters);
+        parentIdx.swap(result.first);
+        ranking.assign(result.second);
+    }
+
+    void getChildren(Population& population, std::vector<int>& parentIdx, Population& children)
+    {
+        children = _ctx.getChildren(population, parentIdx, _parameters);
+    }
+
+    void updatePopulation(Population& population, Population& children, Ranking& ranking)
+    {
+        _ctx.updatePopulation(population, children, ranking.sorted(), _parameters);
+        ranking.invalidate(); // the ProblemCtx does not re-rank, the next getParentIdx starts over
+    }
+
+    bool endSearch() { return _ctx.endSearch(_parameters); }
+};
+
+namespace problem_traits
+{   // detection of each member of the Problem interface, for readable compile errors in GA<Problem>
+    template <typename P> using Pop = typename P::population_type;
+
+    template <typename P, typename = void> struct has_types : std::false_type {};
+    template <typename P>
+    struct has_types<P, std::void_t<typename P::solution_type, typename P::population_type>> : std::true_type {};
+
+    template <typename P, typename = void> struct has_setRandomGenerator : std::false_type {};
+    template <typename P>
+    struct has_setRandomGenerator<P, std::void_t<decltype(
+        std::declval<P&>().setRandomGenerator(std::declval<Philox*>()))>> : std::true_type {};
+
+    template <typename P, typename = void> struct has_setEvaluationQuota : std::false_type {};
+    template <typename P>
+    struct has_setEvaluationQuota<P, std::void_t<decltype(
+        std::declval<P&>().setEvaluationQuota(std::declval<EvaluationQuota*>()))>> : std::true_type {};
+
+    template <typename P, typename = void> struct has_getRandomSolutions : std::false_type {};
+    template <typename P>
+    struct has_getRandomSolutions<P, std::enable_if_t<std::is_same<Pop<P>, decltype(
+        std::declval<P&>().getRandomSolutions(0))>::value>> : std::true_type {};
+
+    template <typename P, typename = void> struct has_getParentIdx : std::false_type {};
+    template <typename P>
+    struct has_getParentIdx<P, std::void_t<decltype(std::declval<P&>().getParentIdx(
+        std::declval<Pop<P>&>(), 0, 0, std::declval<std::vector<int>&>(), std::declval<Ranking&>()))>>
+        : std::true_type {};
+
+    template <typename P, typename = void> struct has_getChildren : std::false_type {};
+    template <typename P>
+    struct has_getChildren<P, std::void_t<decltype(std::declval<P&>().getChildren(
+        std::declval<Pop<P>&>(), std::declval<std::vector<int>&>(), std::declval<Pop<P>&>()))>>
+        : std::true_type {};
+
+    template <typename P, typename = void> struct has_updatePopulation : std::false_type {};
+    template <typename P>
+    struct has_updatePopulation<P, std::void_t<decltype(std::declval<P&>().updatePopulation(
+        std::declval<Pop<P>&>(), std::declval<Pop<P>&>(), std::declval<Ranking&>()))>> : std::true_type {};
+
+    template <typename P, typename = void> struct has_setFitnessCache : std::false_type {};
+    template <typename P>
+    struct has_setFitnessCache<P, std::void_t<decltype(
+        std::declval<P&>().setFitnessCache(std::declval<FitnessCache*>()))>> : std::true_type {};
+
+    template <typename P, typename = void> struct has_steadyState : std::false_type {};
+    template <typename P>
+    struct has_steadyState<P, std::void_t<decltype(std::declval<P&>().breedChildren(
+        std::declval<Pop<P>&>(), std::declval<std::vector<int>&>(), std::declval<Pop<P>&>())), decltype(
+        std::declval<const P&>().evaluateSolution(std::declval<typename P::solution_type&>()))>> : std::true_type {};
+
+    template <typename P, typename = void> struct has_setMutationScale : std::false_type {};
+    template <typename P>
+    struct has_setMutationScale<P, std::void_t<decltype(
+        std::declval<P&>().setMutationScale(0.0f))>> : std::true_type {};
+
+    template <typename P, typename = void> struct has_fillRandomSolutions : std::false_type {};
+    template <typename P>
+    struct has_fillRandomSolutions<P, std::void_t<decltype(
+        std::declval<P&>().getRandomSolutions(0, std::declval<Pop<P>&>()))>> : std::true_type {};
+
+    template <typename P, typename = void> struct has_endSearch : std::false_type {};
+    template <typename P>
+    struct has_endSearch<P, std::enable_if_t<std::is_convertible<decltype(
+        std::declval<P&>().endSearch()), bool>::value>> : std::true_type {};
+} // namespace problem_traits
+
+template <typename P>
+struct check_problem
+{   // instantiated by GA<Problem> to report which part of the interface is missing
+    static_assert(problem_traits::has_types<P>::value, "Problem must define solution_type and population_type");
+    static_assert(problem_traits::has_setRandomGenerator<P>::value, "Problem must define setRandomGenerator(Philox*)");
+    static_assert(problem_traits::has_setEvaluationQuota<P>::value, "Problem must define setEvaluationQuota(EvaluationQuota*)");
+    static_assert(problem_traits::has_getRandomSolutions<P>::value, "Problem must define population_type getRandomSolutions(int)");
+    static_assert(problem_traits::has_getParentIdx<P>::value, "Problem must define getParentIdx(population_type&, int, int, std::vector<int>&, Ranking&)");
+    static_assert(problem_traits::has_getChildren<P>::value, "Problem must define getChildren(population_type&, std::vector<int>&, population_type& children)");
+    static_assert(problem_traits::has_updatePopulation<P>::value, "Problem must define updatePopulation(population_type&, population_type&, Ranking&)");
+    static_assert(problem_traits::has_endSearch<P>::value, "Problem must define bool endSearch()");
+    static_assert(std::is_copy_constructible<P>::value, "Problem must be copyable, each thread works on its own copy");
+    static constexpr bool value = true;
+};
+
+#endif // INCLUDE_GA_PROBLEM
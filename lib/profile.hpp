@@ -0,0 +1,370 @@
+#ifndef INCLUDE_GA_PROFILE
+#define INCLUDE_GA_PROFILE
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <mutex>
+#include <chrono>
+#include <fstream>
+#include <cstdint>
+#include <algorithm>
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#define GA_PROFILE_TSC 1
+#else
+#define GA_PROFILE_TSC 0
+#endif
+
+/* Where the time of a run goes, per island and phase, compiled in only with GA_PROFILE=1 (cmake
+   -DGA_PROFILE=ON). Without it every Scope, count() and Wait is empty and compiles away.
+
+   A Scope marks a phase of the generation loop on the calling thread. Time is charged to the
+   innermost open scope only, so an evaluation inside breeding is not counted twice, and goes to the
+   island the thread is running (IslandScope, -1 outside any island). Counters add up events such as
+   evaluations or boundary repairs the same way. Every thread records into a buffer of its own, read
+   once the run is over: recording takes no lock and touches no shared cache line. Time is read from
+   the cpu's timestamp counter where there is one (a few ns), and converted to ns at the end.
+
+   write() merges the buffers into a json report (per island and in total: ms and calls per phase,
+   every counter) and a Chrome trace (chrome://tracing or ui.perfetto.dev) with a row per island
+   showing each scope. A thread keeps at most traceLimit trace events, later ones are counted as
+   dropped; the totals are always complete. reset(false) records no trace events at all, which
+   roughly halves the cost of a scope (two timestamp reads). */
+
+#ifndef GA_PROFILE
+#define GA_PROFILE 0
+#endif
+
+namespace profile
+{
+    constexpr bool enabled = GA_PROFILE;
+
+    enum class Phase { initialisation, selection, breeding, evaluation, replacement, migration, snapshot, checkpoint,
+                       count };
+
+    enum class Counter { evaluations, boundaryRepairs, migrantsSent, migrantsReceived, cacheHits, cacheMisses, lockWait,
+                         count };
+
+    constexpr int phases = static_cast<int>(Phase::count);
+    constexpr int counters = static_cast<int>(Counter::count);
+
+    static const char* const phaseNames[phases] = {"initialisation", "selection", "breeding", "evaluation",
+                                                    "replacement", "migration", "snapshot", "checkpoint"};
+    static const char* const counterNames[counters] = {"evaluations", "boundary repairs", "migrants sent",
+                                                        "migrants received", "cache hits", "cache misses",
+                                                        "lock wait ms"};
+
+    inline uint64_t tick()
+    {
+#if GA_PROFILE_TSC
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+#if GA_PROFILE
+    constexpr size_t traceLimit = 1 << 20; // trace events per thread
+
+    struct Totals
+    {
+        uint64_t ticks[phases] = {};
+        uint64_t calls[phases] = {};
+        uint64_t counts[counters] = {}; // lockWait in ticks
+    };
+
+    struct Event
+    {   // 16 bytes, so a thread's trace stays small
+        uint64_t start;
+        uint32_t duration; // ticks, saturating
+        int16_t island;
+        uint8_t phase;
+    };
+
+    struct Buffer
+    {   // one thread's record, written by that thread only
+        std::vector<Totals> islands; // island i at i+1, the thread outside any island at 0
+        std::vector<Event> events;
+        bool tracing = true;
+        uint64_t dropped = 0;
+        int island = -1;
+        int phase = -1;  // innermost open scope, -1: none
+        uint64_t since = 0;
+
+        Totals& totals()
+        {
+            if(island + 1 >= islands.size()) islands.resize(island + 2);
+            return islands[island + 1];
+        }
+
+        void charge(uint64_t now)
+        {   // the time since the last switch goes to the innermost open scope
+            if(phase >= 0) totals().ticks[phase] += now - since;
+            since = now;
+        }
+    };
+
+    class Registry
+    {
+    private:
+        std::mutex _guard;
+        std::vector<std::unique_ptr<Buffer>> _buffers; // kept after their thread exits
+        bool _tracing = true;
+        uint64_t _startTick = 0;
+        std::chrono::steady_clock::time_point _start;
+
+    public:
+        Registry() { reset(true); }
+
+        Buffer* add()
+        {   // the first events are paged in up front, so recording them does not fault
+            std::lock_guard<std::mutex> lock(_guard);
+            _buffers.push_back(std::make_unique<Buffer>());
+            Buffer* b = _buffers.back().get();
+            b->tracing = _tracing;
+            if(_tracing)
+            {
+                b->events.resize(1 << 16);
+                b->events.clear();
+            }
+            return b;
+        }
+
+        void reset(bool tracing)
+        {   // only while no thread is recording
+            std::lock_guard<std::mutex> lock(_guard);
+            _tracing = tracing;
+            for(auto& buffer : _buffers)
+            {
+                buffer->islands.clear();
+                buffer->events.clear();
+                buffer->tracing = tracing;
+                buffer->dropped = 0;
+            }
+            _startTick = tick();
+            _start = std::chrono::steady_clock::now();
+        }
+
+        template <typename F>
+        void forEach(F&& f)
+        {
+            std::lock_guard<std::mutex> lock(_guard);
+            for(auto& buffer : _buffers) f(*buffer);
+        }
+
+        uint64_t startTick() const { return _startTick; }
+
+        double nsPerTick() const
+        {   // the timestamp counter calibrated against the steady clock over the whole recording
+            const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - _start).count();
+            const uint64_t ticks = tick() - _startTick;
+            return ticks > 0 ? ns / ticks : 1;
+        }
+    };
+
+    inline Registry& registry()
+    {
+        static Registry r;
+        return r;
+    }
+
+    inline Buffer& buffer()
+    {
+        static thread_local Buffer* b = registry().add();
+        return *b;
+    }
+
+    class Scope
+    {   // the calling thread is in phase until the scope closes
+    private:
+        Buffer& _b;
+        int _phase;
+        int _outer;
+        uint64_t _start;
+
+    public:
+        explicit Scope(Phase phase) : _b(buffer()), _phase(static_cast<int>(phase))
+        {
+            _start = tick();
+            _b.charge(_start);
+            _outer = _b.phase;
+            _b.phase = _phase;
+        }
+
+        ~Scope()
+        {
+            const uint64_t now = tick();
+            _b.charge(now);
+            _b.totals().calls[_phase] += 1;
+            _b.phase = _outer;
+            if(!_b.tracing) return;
+            const uint32_t duration = std::min<uint64_t>(now - _start, UINT32_MAX);
+            if(_b.events.size() < traceLimit) 
+                _b.events.push_back(Event{_start, duration, static_cast<int16_t>(_b.island), static_cast<uint8_t>(_phase)});
+            else _b.dropped += 1;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    class IslandScope
+    {   // the calling thread runs island until the scope closes
+    private:
+        Buffer& _b;
+        int _outer;
+
+    public:
+        explicit IslandScope(int island) : _b(buffer()), _outer(_b.island)
+        {
+            _b.charge(tick());
+            _b.island = island;
+        }
+
+        ~IslandScope()
+        {
+            _b.charge(tick());
+            _b.island = _outer;
+        }
+    };
+
+    inline void count(Counter counter, uint64_t n = 1) { buffer().totals().counts[static_cast<int>(counter)] += n; }
+
+    class Wait
+    {   // time spent until the scope closes is lock wait
+    private:
+        uint64_t _start;
+
+    public:
+        Wait() : _start(tick()) {}
+        ~Wait() { count(Counter::lockWait, tick() - _start); }
+    };
+
+    inline void reset(bool tracing = true) { registry().reset(tracing); }
+
+    void writeTotals(std::ostream& out, const Totals& t, double msPerTick, const std::string& indent)
+    {   // the "phases" and "counters" members of a report entry
+        out << "\"phases\": {";
+        for(int p=0; p<phases; p++)
+        {
+            out << (p ? "," : "") << '\n' << indent << "    \"" << phaseNames[p] << "\": {\"ms\": "
+                << t.ticks[p] * msPerTick << ", \"calls\": " << t.calls[p] << '}';
+        }
+        out << "},\n" << indent << "  \"counters\": {";
+        for(int c=0; c<counters; c++)
+        {
+            out << (c ? ", " : "") << '"' << counterNames[c] << "\": ";
+            if(static_cast<Counter>(c) == Counter::lockWait) out << t.counts[c] * msPerTick;
+            else out << t.counts[c];
+        }
+        out << '}';
+    }
+
+    bool write(const std::string& reportPath, const std::string& tracePath)
+    {   // merge every thread's record, only once no thread is recording. An empty path skips that file
+        const double msPerTick = registry().nsPerTick() / 1e6;
+        const uint64_t startTick = registry().startTick();
+        std::vector<Totals> islands;
+        Totals total;
+        uint64_t events = 0;
+        uint64_t dropped = 0;
+        registry().forEach([&](Buffer& b){
+            if(b.islands.size() > islands.size()) islands.resize(b.islands.size());
+            for(int i=0; i<b.islands.size(); i++)
+            {
+                for(int p=0; p<phases; p++)
+                {
+                    islands[i].ticks[p] += b.islands[i].ticks[p];
+                    islands[i].calls[p] += b.islands[i].calls[p];
+                    total.ticks[p] += b.islands[i].ticks[p];
+                    total.calls[p] += b.islands[i].calls[p];
+                }
+                for(int c=0; c<counters; c++)
+                {
+                    islands[i].counts[c] += b.islands[i].counts[c];
+                    total.counts[c] += b.islands[i].counts[c];
+                }
+            }
+            events += b.events.size();
+            dropped += b.dropped;
+        });
+
+        bool ok = true;
+        if(!reportPath.empty())
+        {
+            std::ofstream out(reportPath, std::ios::out|std::ios::trunc);
+            out << "{\n  \"clock\": \"" << (GA_PROFILE_TSC ? "tsc" : "steady_clock") << "\",\n"
+                << "  \"trace events\": " << events << ",\n  \"trace events dropped\": " << dropped << ",\n"
+                << "  \"total\": {";
+            writeTotals(out, total, msPerTick, "  ");
+            out << "},\n  \"islands\": [";
+            bool first = true;
+            for(int i=0; i<islands.size(); i++)
+            {   // entry 0 is the time outside any island, eg. the initial population
+                out << (first ? "" : ",") << "\n    {\"island\": " << (i == 0 ? "null" : std::to_string(i)) << ",\n      ";
+                writeTotals(out, islands[i], msPerTick, "    ");
+                out << '}';
+                first = false;
+            }
+            out << "\n  ]\n}\n";
+            ok = ok && static_cast<bool>(out);
+        }
+        if(!tracePath.empty())
+        {   // complete ("X") events in microseconds, island i on row i, work outside the islands on row 0
+            std::ofstream out(tracePath, std::ios::out|std::ios::trunc);
+            out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+            bool first = true;
+            const double usPerTick = msPerTick * 1e3;
+            for(int i=0; i<=islands.size(); i++)
+            {
+                out << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << i
+                    << ", \"args\": {\"name\": \"" << (i == 0 ? std::string("run") : "island " + std::to_string(i)) << "\"}}";
+                first = false;
+            }
+            registry().forEach([&](Buffer& b){
+                for(const Event& e : b.events)
+                {
+                    out << ",\n{\"name\": \"" << phaseNames[e.phase] << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+                        << e.island + 1 << ", \"ts\": " << (e.start - startTick) * usPerTick
+                        << ", \"dur\": " << e.duration * usPerTick << "}";
+                }
+            });
+            out << "\n]}\n";
+            ok = ok && static_cast<bool>(out);
+        }
+        return ok;
+    }
+#else
+    // user-provided constructors and destructors, so the guards never count as unused variables
+    class Scope
+    {
+    public:
+        explicit Scope(Phase) {}
+        ~Scope() {}
+    };
+
+    class IslandScope
+    {
+    public:
+        explicit IslandScope(int) {}
+        ~IslandScope() {}
+    };
+
+    class Wait
+    {
+    public:
+        Wait() {}
+        ~Wait() {}
+    };
+
+    inline void count(Counter, uint64_t = 1) {}
+
+    inline void reset(bool = true) {}
+
+    inline bool write(const std::string&, const std::string&) { return true; }
+#endif // GA_PROFILE
+} // namespace profile
+
+#endif // INCLUDE_GA_PROFILE
@@ -0,0 +1,327 @@
+#ifndef INCLUDE_GA_RANDOM
+#define INCLUDE_GA_RANDOM
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include "simd.hpp"
+
+/* Counter-based random numbers: Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as
+   1, 2, 3", SC 2011). Each output block is a keyed bijection of a 128 bit counter, so a stream is
+   just (key, counter) in 24 bytes, any number of independent streams come from one seed by giving
+   each its own stream id, and jumping ahead is free.
+
+   Philox is a C++ UniformRandomBitGenerator, so it works with the <random> distributions. The bulk
+   fills generate 16 blocks at a time (with AVX2/AVX-512 when the cpu has them) in a fixed word
+   order, so the raw words and the uniforms are the same on every instruction set (checked, with the
+   Random123 known answers, by bench/philox_check.cpp). Normals come from Box-Muller, vectorised with
+   the polynomial log/sin of simd.hpp, so they agree to the last bit only between machines
+   dispatching to the same instruction set (like the objective kernels). */
+
+namespace philox
+{
+    constexpr uint32_t M0 = 0xD2511F53;
+    constexpr uint32_t M1 = 0xCD9E8D57;
+    constexpr uint32_t W0 = 0x9E3779B9;
+    constexpr uint32_t W1 = 0xBB67AE85;
+    constexpr int lanes = 16; // blocks per bulk group
+    constexpr int groupWords = 4 * lanes;
+    constexpr float twoPi = 6.283185307179586f;
+    constexpr float halfPi = 1.5707963267948966f;
+
+    inline float toUniform(uint32_t x)
+    {   // [0, 1) with the 24 bits a float holds
+        return (x >> 8) * (1.0f / 16777216.0f);
+    }
+
+    inline float toOpenUniform(uint32_t x)
+    {   // (0, 1], safe to take the log of
+        return ((x >> 8) + 1) * (1.0f / 16777216.0f);
+    }
+
+    inline void block(uint32_t c[4], uint32_t k0, uint32_t k1)
+    {   // 10 rounds in place
+        for(int r=0; r<10; r++)
+        {
+            uint64_t p0 = static_cast<uint64_t>(M0) * c[0];
+            uint64_t p1 = static_cast<uint64_t>(M1) * c[2];
+            uint32_t x0 = static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ k0;
+            uint32_t x1 = static_cast<uint32_t>(p1);
+            uint32_t x2 = static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ k1;
+            uint32_t x3 = static_cast<uint32_t>(p0);
+            c[0] = x0; c[1] = x1; c[2] = x2; c[3] = x3;
+            k0 += W0;
+            k1 += W1;
+        }
+    }
+
+    // groupScalar/AVX2/AVX512 write the blocks of counters (c0+lane, c1, c2, c3), lane < 16, as
+    // out[word*16 + lane]. c0 must be a multiple of 16 so the lanes never carry into c1
+    inline void groupScalar(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3, uint32_t k0, uint32_t k1, uint32_t* out)
+    {
+        for(int lane=0; lane<lanes; lane++)
+        {
+            uint32_t c[4] = {c0 + lane, c1, c2, c3};
+            block(c, k0, k1);
+            for(int w=0; w<4; w++) out[w*lanes + lane] = c[w];
+        }
+    }
+
+#if GA_SIMD_X86
+    GA_TARGET_AVX2 inline void mulhilo256(__m256i x, __m256i m, __m256i& hi, __m256i& lo)
+    {   // 32x32 -> 64 bit products of every lane, _mm256_mul_epu32 only multiplies the even lanes
+        __m256i even = _mm256_mul_epu32(x, m);
+        __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), m);
+        hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+        lo = _mm256_mullo_epi32(x, m);
+    }
+
+    GA_TARGET_AVX2 inline void groupAVX2(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3, uint32_t k0, uint32_t k1, uint32_t* out)
+    {
+        const __m256i m0 = _mm256_set1_epi32(M0);
+        const __m256i m1 = _mm256_set1_epi32(M1);
+        for(int half=0; half<lanes; half+=8)
+        {
+            __m256i x0 = _mm256_add_epi32(_mm256_set1_epi32(c0 + half), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+            __m256i x1 = _mm256_set1_epi32(c1);
+            __m256i x2 = _mm256_set1_epi32(c2);
+            __m256i x3 = _mm256_set1_epi32(c3);
+            uint32_t key0 = k0, key1 = k1;
+            for(int r=0; r<10; r++)
+            {
+                __m256i hi0, lo0, hi1, lo1;
+                mulhilo256(x0, m0, hi0, lo0);
+                mulhilo256(x2, m1, hi1, lo1);
+                x0 = _mm256_xor_si256(_mm256_xor_si256(hi1, x1), _mm256_set1_epi32(key0));
+                x1 = lo1;
+                x2 = _mm256_xor_si256(_mm256_xor_si256(hi0, x3), _mm256_set1_epi32(key1));
+                x3 = lo0;
+                key0 += W0;
+                key1 += W1;
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 0*lanes + half), x0);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 1*lanes + half), x1);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2*lanes + half), x2);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 3*lanes + half), x3);
+        }
+    }
+
+    GA_TARGET_AVX512 inline void mulhilo512(__m512i x, __m512i m, __m512i& hi, __m512i& lo)
+    {
+        __m512i even = _mm512_mul_epu32(x, m);
+        __m512i odd = _mm512_mul_epu32(_mm512_srli_epi64(x, 32), m);
+        hi = _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(even, 32), odd);
+        lo = _mm512_mullo_epi32(x, m);
+    }
+
+    GA_TARGET_AVX512 inline void groupAVX512(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3, uint32_t k0, uint32_t k1, uint32_t* out)
+    {
+        const __m512i m0 = _mm512_set1_epi32(M0);
+        const __m512i m1 = _mm512_set1_epi32(M1);
+        __m512i x0 = _mm512_add_epi32(_mm512_set1_epi32(c0),
+                                      _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+        __m512i x1 = _mm512_set1_epi32(c1);
+        __m512i x2 = _mm512_set1_epi32(c2);
+        __m512i x3 = _mm512_set1_epi32(c3);
+        for(int r=0; r<10; r++)
+        {
+            __m512i hi0, lo0, hi1, lo1;
+            mulhilo512(x0, m0, hi0, lo0);
+            mulhilo512(x2, m1, hi1, lo1);
+            x0 = _mm512_xor_si512(_mm512_xor_si512(hi1, x1), _mm512_set1_epi32(k0));
+            x1 = lo1;
+            x2 = _mm512_xor_si512(_mm512_xor_si512(hi0, x3), _mm512_set1_epi32(k1));
+            x3 = lo0;
+            k0 += W0;
+            k1 += W1;
+        }
+        _mm512_storeu_si512(out + 0*lanes, x0);
+        _mm512_storeu_si512(out + 1*lanes, x1);
+        _mm512_storeu_si512(out + 2*lanes, x2);
+        _mm512_storeu_si512(out + 3*lanes, x3);
+    }
+
+    GA_TARGET_AVX2 inline void normalsAVX2(const uint32_t* words, float* out)
+    {
+        const __m256 scale = _mm256_set1_ps(1.0f / 16777216.0f);
+        for(int j=0; j<groupWords/2; j+=8)
+        {
+            __m256i w1 = _mm256_srli_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + j)), 8);
+            __m256i w2 = _mm256_srli_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + groupWords/2 + j)), 8);
+            __m256 u1 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(w1, _mm256_set1_epi32(1))), scale);
+            __m256 theta = _mm256_mul_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(w2), scale), _mm256_set1_ps(twoPi));
+            __m256 r = _mm256_sqrt_ps(_mm256_mul_ps(_mm256_set1_ps(-2.0f), simd::log256(u1)));
+            _mm256_storeu_ps(out + j, _mm256_mul_ps(r, simd::sin256(_mm256_add_ps(theta, _mm256_set1_ps(halfPi)))));
+            _mm256_storeu_ps(out + groupWords/2 + j, _mm256_mul_ps(r, simd::sin256(theta)));
+        }
+    }
+
+    GA_TARGET_AVX512 inline void normalsAVX512(const uint32_t* words, float* out)
+    {
+        const __m512 scale = _mm512_set1_ps(1.0f / 16777216.0f);
+        for(int j=0; j<groupWords/2; j+=16)
+        {
+            __m512i w1 = _mm512_srli_epi32(_mm512_loadu_si512(words + j), 8);
+            __m512i w2 = _mm512_srli_epi32(_mm512_loadu_si512(words + groupWords/2 + j), 8);
+            __m512 u1 = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_add_epi32(w1, _mm512_set1_epi32(1))), scale);
+            __m512 theta = _mm512_mul_ps(_mm512_mul_ps(_mm512_cvtepi32_ps(w2), scale), _mm512_set1_ps(twoPi));
+            __m512 r = _mm512_sqrt_ps(_mm512_mul_ps(_mm512_set1_ps(-2.0f), simd::log512(u1)));
+            _mm512_storeu_ps(out + j, _mm512_mul_ps(r, simd::sin512(_mm512_add_ps(theta, _mm512_set1_ps(halfPi)))));
+            _mm512_storeu_ps(out + groupWords/2 + j, _mm512_mul_ps(r, simd::sin512(theta)));
+        }
+    }
+#endif // GA_SIMD_X86
+
+    inline void normalsScalar(const uint32_t* words, float* out)
+    {
+        for(int j=0; j<groupWords/2; j++)
+        {
+            float r = std::sqrt(-2.0f * std::log(toOpenUniform(words[j])));
+            float theta = twoPi * toUniform(words[groupWords/2 + j]);
+            out[j] = r * std::cos(theta);
+            out[groupWords/2 + j] = r * std::sin(theta);
+        }
+    }
+
+    inline void normals(const uint32_t* words, float* out)
+    {   // Box-Muller on the 64 words of a group: words j and 32+j give normals j and 32+j
+#if GA_SIMD_X86
+        switch(simd::activeIsa())
+        {
+            case simd::Isa::avx512: return normalsAVX512(words, out);
+            case simd::Isa::avx2: return normalsAVX2(words, out);
+            default: break;
+        }
+#endif
+        normalsScalar(words, out);
+    }
+
+    inline void group(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3, uint32_t k0, uint32_t k1, uint32_t* out)
+    {   // the widest kernel the cpu supports, every kernel gives the same words
+#if GA_SIMD_X86
+        switch(simd::activeIsa())
+        {
+            case simd::Isa::avx512: return groupAVX512(c0, c1, c2, c3, k0, k1, out);
+            case simd::Isa::avx2: return groupAVX2(c0, c1, c2, c3, k0, k1, out);
+            default: break;
+        }
+#endif
+        groupScalar(c0, c1, c2, c3, k0, k1, out);
+    }
+
+} // namespace philox
+
+class Philox
+{
+private:
+    uint32_t _key[2];
+    uint64_t _counter;    // counter words 0 and 1
+    uint32_t _stream;     // counter word 2, the stream id
+    uint32_t _block[4];   // the current block for operator()
+    int _index;           // next unused word of _block
+    float _spareNormal;
+    bool _hasSpare;
+
+public:
+    typedef uint32_t result_type;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xffffffff; }
+
+    explicit Philox(uint64_t seed = 0, uint32_t stream = 0)
+        : _key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}, _counter(0), _stream(stream),
+          _index(4), _hasSpare(false) {}
+
+    result_type operator()()
+    {
+        if(_index == 4)
+        {
+            _block[0] = static_cast<uint32_t>(_counter);
+            _block[1] = static_cast<uint32_t>(_counter >> 32);
+            _block[2] = _stream;
+            _block[3] = 0;
+            philox::block(_block, _key[0], _key[1]);
+            _counter += 1;
+            _index = 0;
+        }
+        return _block[_index++];
+    }
+
+    void discard(unsigned long long n)
+    {
+        for(unsigned long long i=0; i<n; i++) (*this)();
+    }
+
+    template <typename Archive>
+    void checkpoint(Archive& archive)
+    {   // the whole stream position, see checkpoint.hpp
+        archive.io(_key);
+        archive.io(_counter);
+        archive.io(_stream);
+        archive.io(_block);
+        archive.io(_index);
+        archive.io(_spareNormal);
+        archive.io(_hasSpare);
+    }
+
+    uint64_t counter() const { return _counter; }
+    uint32_t stream() const { return _stream; }
+
+    void fillBits(uint32_t* out, int n)
+    {   // n raw words from whole groups of 16 blocks, starting at the next counter that is a multiple of 16
+        _counter = (_counter + philox::lanes - 1) / philox::lanes * philox::lanes;
+        _index = 4;
+        alignas(64) uint32_t words[philox::groupWords];
+        for(int i=0; i<n; i+=philox::groupWords)
+        {
+            philox::group(static_cast<uint32_t>(_counter), static_cast<uint32_t>(_counter >> 32), _stream, 0,
+                          _key[0], _key[1], words);
+            _counter += philox::lanes;
+            std::copy(words, words + std::min(philox::groupWords, n - i), out + i);
+        }
+    }
+
+    void fillUniform(float* out, int n, float lowerbound, float upperbound)
+    {   // n floats uniform in [lowerbound, upperbound)
+        alignas(64) uint32_t bits[philox::groupWords];
+        for(int i=0; i<n; i+=philox::groupWords)
+        {
+            const int m = std::min(philox::groupWords, n - i);
+            fillBits(bits, m);
+            for(int j=0; j<m; j++) out[i+j] = lowerbound + (upperbound - lowerbound) * philox::toUniform(bits[j]);
+        }
+    }
+
+    void fillNormal(float* out, int n, float mean = 0, float stddev = 1)
+    {   // n normal floats, each group of 16 blocks gives 64 by Box-Muller
+        alignas(64) uint32_t bits[philox::groupWords];
+        alignas(64) float z[philox::groupWords];
+        for(int i=0; i<n; i+=philox::groupWords)
+        {
+            const int m = std::min(philox::groupWords, n - i);
+            fillBits(bits, philox::groupWords);
+            philox::normals(bits, z);
+            for(int j=0; j<m; j++) out[i+j] = mean + stddev * z[j];
+        }
+    }
+
+    float uniform()
+    {   // one float in [0, 1)
+        return philox::toUniform((*this)());
+    }
+
+    float normal()
+    {   // one standard normal, Box-Muller keeping the second variate for the next call
+        if(_hasSpare)
+        {
+            _hasSpare = false;
+            return _spareNormal;
+        }
+        float r = std::sqrt(-2.0f * std::log(philox::toOpenUniform((*this)())));
+        float theta = philox::twoPi * philox::toUniform((*this)());
+        _spareNormal = r * std::sin(theta);
+        _hasSpare = true;
+        return r * std::cos(theta);
+    }
+};
+
+#endif // INCLUDE_GA_RANDOM
@@ -0,0 +1,128 @@
+#ifndef INCLUDE_GA_RANKING
+#define INCLUDE_GA_RANKING
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+/* The (fitness, index) pairs of a population kept sorted best (lowest fitness) first across
+   generations. It is built with one full sort, then each generation only the replaced members are
+   re-ranked: replaceWorst() sorts the k new entries and merges them in from the back, and update()
+   moves a single entry when one member changes (eg. a migration swap). Selection reads ranks
+   directly, so no generation after the first sorts the whole population again. The sum of the
+   fitness is kept along the same way, so mean() never needs a pass over the population either. */
+
+class Ranking
+{
+private:
+    std::vector<std::pair<float, int>> _sorted;   // ascending by (fitness, index), ie. rank 0 is the best
+    std::vector<std::pair<float, int>> _incoming; // scratch for replaceWorst
+    double _sum = 0;     // of the fitness of the bounded entries
+    int _unbounded = 0;  // entries at (or beyond) the largest float, eg. infeasible solutions, kept out of
+                         // _sum so they cannot swamp it
+
+    void accumulate(float fitness, int sign)
+    {
+        if(std::fabs(fitness) < std::numeric_limits<float>::max()) _sum += sign * static_cast<double>(fitness);
+        else _unbounded += sign;
+    }
+
+    void resum()
+    {
+        _sum = 0;
+        _unbounded = 0;
+        for(auto& entry : _sorted) accumulate(entry.first, 1);
+    }
+
+public:
+    int size() const { return _sorted.size(); }
+    bool empty() const { return _sorted.empty(); }
+
+    // the entry of rank r (0 is the best, size()-1 the worst)
+    const std::pair<float, int>& operator[](int r) const { return _sorted[r]; }
+
+    // the population index of the i-th worst member (i = 0 is the worst)
+    int worst(int i) const { return _sorted[_sorted.size()-1-i].second; }
+
+    const std::vector<std::pair<float, int>>& sorted() const { return _sorted; }
+
+    double mean() const
+    {   // mean fitness, the largest float while any entry is unbounded
+        if(_unbounded > 0) return std::numeric_limits<float>::max();
+        return _sorted.empty() ? 0 : _sum / _sorted.size();
+    }
+
+    void invalidate()
+    {
+        _sorted.clear();
+        resum();
+    }
+
+    template <typename Population>
+    void rebuild(Population& population, int rangeStart, int rangeEnd)
+    {   // full sort of population[rangeStart:rangeEnd]
+        _sorted.clear();
+        _sorted.reserve(rangeEnd - rangeStart);
+        _incoming.reserve(rangeEnd - rangeStart);
+        for(int i=rangeStart; i<rangeEnd; i++) _sorted.push_back(std::pair<float, int>(population[i].getEval(), i));
+        std::sort(_sorted.begin(), _sorted.end());
+        resum();
+    }
+
+    void assign(std::vector<std::pair<float, int>>& sorted)
+    {   // take over an already sorted array (swapped in, so no copy)
+        _sorted.swap(sorted);
+        resum();
+    }
+
+    template <typename F>
+    void replaceWorst(int k, F&& newFitness)
+    {   // the i-th worst member (i < k) now has fitness newFitness(i), keep its index and re-rank
+        const int n = _sorted.size();
+        k = std::min(k, n);
+        if(k <= 0) return;
+        _incoming.clear();
+        for(int i=0; i<k; i++)
+        {
+            _incoming.push_back(std::pair<float, int>(newFitness(i), _sorted[n-1-i].second));
+            accumulate(_sorted[n-1-i].first, -1);
+            accumulate(_incoming.back().first, 1);
+        }
+        std::sort(_incoming.begin(), _incoming.end());
+
+        // merge _sorted[0:n-k] and _incoming into _sorted from the back, only the tail moves
+        int a = n - k - 1;
+        int b = k - 1;
+        int w = n - 1;
+        while(b >= 0)
+        {
+            if(a >= 0 && _incoming[b] < _sorted[a]) _sorted[w--] = _sorted[a--];
+            else _sorted[w--] = _incoming[b--];
+        }
+    }
+
+    void update(int index, float oldFitness, float newFitness)
+    {   // population[index] changed fitness from oldFitness to newFitness
+        auto it = std::lower_bound(_sorted.begin(), _sorted.end(), std::pair<float, int>(oldFitness, index));
+        assert(it != _sorted.end() && it->second == index);
+        accumulate(oldFitness, -1);
+        accumulate(newFitness, 1);
+        std::pair<float, int> entry(newFitness, index);
+        if(entry < *it)
+        {   // moves towards the best, shift the entries in between one place back
+            auto to = std::lower_bound(_sorted.begin(), it, entry);
+            std::move_backward(to, it, it + 1);
+            *to = entry;
+        }else
+        {
+            auto to = std::lower_bound(it + 1, _sorted.end(), entry);
+            std::move(it + 1, to, it);
+            *(to - 1) = entry;
+        }
+    }
+};
+
+#endif // INCLUDE_GA_RANKING
@@ -0,0 +1,172 @@
+#ifndef INCLUDE_GA_SELECTION
+#define INCLUDE_GA_SELECTION
+
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include "config.hpp"
+
+/* Parent selection over ranks, rank 0 being the best solution of a population of N. All methods
+   except tournament follow linear ranking,
+
+       p(rank R) = (S*(N+1-2R) + 2*(R-1)) / (N*(N-1)),   R = 1..N, S = selection pressure in [1, 2]
+
+   ranking     each rank is chosen independently with p(R), so the number of parents varies
+               (1 on average) and count is ignored. Candidates are drawn with geometric skips,
+               O(S + parents) draws per generation
+   alias       exactly count parents drawn from p with Vose's alias table, two draws each
+   sus         stochastic universal sampling: count equally spaced pointers into the cdf of p from a
+               single draw, so each rank gets within one of its expected share
+   tournament  exactly count parents, each the best of tournamentSize uniformly drawn ranks
+
+   Tables are rebuilt by prepare() only when (N, S) changes, so in steady state sample() neither
+   allocates nor touches more than the ranks it returns. */
+
+enum class SelectionMethod { ranking, alias, sus, tournament };
+
+SelectionMethod parseSelectionMethod(const std::string& name)
+{
+    if(name == "ranking") return SelectionMethod::ranking;
+    if(name == "alias") return SelectionMethod::alias;
+    if(name == "sus") return SelectionMethod::sus;
+    if(name == "tournament") return SelectionMethod::tournament;
+    throw ConfigError("unknown selection method \"" + name + "\" (ranking, alias, sus or tournament)");
+}
+
+// linear ranking probability of rank (1 is the best) among n
+double rankProbability(int rank, int n, float pressure)
+{
+    return (pressure * (n + 1.0 - 2.0 * rank) + 2.0 * (rank - 1)) / (static_cast<double>(n) * (n - 1));
+}
+
+class RankSelector
+{
+private:
+    SelectionMethod _method;
+    int _tournamentSize;
+    int _n;
+    float _pressure;
+    std::vector<float> _accept; // alias: probability of keeping slot i rather than taking _alias[i]
+    std::vector<int> _alias;
+    std::vector<double> _cdf;   // sus: cdf[r] = p(rank <= r+1)
+
+    void buildAlias()
+    {   // Vose's method, slots under the mean are topped up by one slot over it
+        std::vector<double> scaled(_n);
+        std::vector<int> small, large;
+        _accept.assign(_n, 1.0f);
+        _alias.resize(_n);
+        for(int r=0; r<_n; r++)
+        {
+            _alias[r] = r;
+            scaled[r] = rankProbability(r+1, _n, _pressure) * _n;
+            (scaled[r] < 1.0 ? small : large).push_back(r);
+        }
+        while(!small.empty() && !large.empty())
+        {
+            int s = small.back(); small.pop_back();
+            int l = large.back();
+            _accept[s] = scaled[s];
+            _alias[s] = l;
+            scaled[l] -= 1.0 - scaled[s];
+            if(scaled[l] < 1.0)
+            {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        // whatever is left is 1 up to rounding and keeps _accept = 1
+    }
+
+    void buildCdf()
+    {
+        _cdf.resize(_n);
+        double sum = 0;
+        for(int r=0; r<_n; r++)
+        {
+            sum += rankProbability(r+1, _n, _pressure);
+            _cdf[r] = sum;
+        }
+        _cdf.back() = 1.0; // the pointers never run past the last rank through rounding
+    }
+
+public:
+    explicit RankSelector(SelectionMethod method = SelectionMethod::ranking, int tournamentSize = 2)
+        : _method(method), _tournamentSize(tournamentSize), _n(0), _pressure(0) {}
+
+    SelectionMethod method() const { return _method; }
+
+    void prepare(int n, float pressure)
+    {   // precompute the tables for n ranks, a no-op while (n, pressure) is unchanged
+        if(n == _n && pressure == _pressure) return;
+        _n = n;
+        _pressure = pressure;
+        if(_n < 2) return;
+        if(_method == SelectionMethod::alias) buildAlias();
+        if(_method == SelectionMethod::sus) buildCdf();
+    }
+
+    template <typename Gen>
+    void sample(int count, Gen& gen, std::vector<int>& ranks)
+    {   // ranks (0 is the best) of the selected parents, see prepare()
+        ranks.clear();
+        if(_n < 2) return;
+        switch(_method)
+        {
+            case SelectionMethod::ranking:
+            {   // p is largest for the best rank (S/N), candidate ranks are drawn with geometric skips
+                // at that rate and each is kept with p(R)/(S/N). From a rate of 1/2 on skips save next to
+                // nothing, so every rank is tried instead and kept with p(R)
+                const float pMax = _pressure / _n;
+                const bool everyRank = pMax >= 0.5f;
+                std::geometric_distribution<int> skip(everyRank ? 0.5f : pMax);
+                auto nextSkip = [&](){ return everyRank ? 0 : skip(gen); };
+                std::uniform_real_distribution<float> urand(0, everyRank ? 1.0f : pMax);
+                for(int r=nextSkip(); r<_n; r+=1+nextSkip())
+                {
+                    if(urand(gen) < rankProbability(r+1, _n, _pressure)) ranks.push_back(r);
+                }
+                break;
+            }
+            case SelectionMethod::alias:
+            {   // one draw picks the slot, a second decides slot or alias, so neither loses precision as
+                // the population grows
+                std::uniform_int_distribution<int> slots(0, _n-1);
+                std::uniform_real_distribution<float> urand(0, 1);
+                for(int i=0; i<count; i++)
+                {
+                    const int slot = slots(gen);
+                    ranks.push_back(urand(gen) < _accept[slot] ? slot : _alias[slot]);
+                }
+                break;
+            }
+            case SelectionMethod::sus:
+            {
+                if(count <= 0) break;
+                const double step = 1.0 / count;
+                double pointer = std::uniform_real_distribution<double>(0, step)(gen);
+                auto it = _cdf.begin();
+                for(int i=0; i<count; i++, pointer+=step)
+                {
+                    it = std::upper_bound(it, _cdf.end() - 1, pointer);
+                    ranks.push_back(it - _cdf.begin());
+                }
+                break;
+            }
+            case SelectionMethod::tournament:
+            {
+                std::uniform_int_distribution<int> rank(0, _n-1);
+                for(int i=0; i<count; i++)
+                {
+                    int best = rank(gen);
+                    for(int t=1; t<_tournamentSize; t++) best = std::min(best, rank(gen));
+                    ranks.push_back(best);
+                }
+                break;
+            }
+        }
+    }
+};
+
+#endif // INCLUDE_GA_SELECTION
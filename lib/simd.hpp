@@ -0,0 +1,202 @@
+#ifndef INCLUDE_GA_SIMD
+#define INCLUDE_GA_SIMD
+
+#include <atomic>
+
+// vectorised math kernels are only built for x86 with a GCC-compatible compiler, every other
+// target falls back to the scalar path
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define GA_SIMD_X86 1
+#include <immintrin.h>
+#define GA_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define GA_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#else
+#define GA_SIMD_X86 0
+#endif
+
+namespace simd
+{
+
+enum class Isa { scalar = 0, avx2 = 1, avx512 = 2 };
+
+static std::atomic<int> forcedIsa{-1}; // -1 means use whatever the cpu supports
+
+Isa detectIsa()
+{   // query the cpu once for the widest instruction set we have kernels for
+#if GA_SIMD_X86
+    static const Isa detected = []{
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512f")) return Isa::avx512;
+        if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return Isa::avx2;
+        return Isa::scalar;
+    }();
+    return detected;
+#else
+    return Isa::scalar;
+#endif
+}
+
+Isa activeIsa()
+{   // the instruction set batch kernels should dispatch to
+    int forced = forcedIsa.load(std::memory_order_relaxed);
+    if(forced >= 0 && forced <= static_cast<int>(detectIsa())) return static_cast<Isa>(forced);
+    return detectIsa();
+}
+
+void forceIsa(Isa isa)
+{   // restrict dispatch to isa (eg. for benchmarking), requests above what the cpu supports are ignored
+    forcedIsa.store(static_cast<int>(isa), std::memory_order_relaxed);
+}
+
+const char* isaName(Isa isa)
+{
+    switch(isa)
+    {
+        case Isa::avx512: return "avx512";
+        case Isa::avx2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+#if GA_SIMD_X86
+/* sin(x) for 8/16 floats at once, using the cephes sinf range reduction and minimax polynomials
+   (max error ~2 ulp on |x| < 8192, which covers every argument the example problems produce) */
+
+namespace detail
+{
+    constexpr float fourOverPi = 1.27323954473516f;
+    constexpr float dp1 = -0.78515625f;
+    constexpr float dp2 = -2.4187564849853515625e-4f;
+    constexpr float dp3 = -3.77489497744594108e-8f;
+    constexpr float sinP0 = -1.9515295891e-4f;
+    constexpr float sinP1 = 8.3321608736e-3f;
+    constexpr float sinP2 = -1.6666654611e-1f;
+    constexpr float cosP0 = 2.443315711809948e-5f;
+    constexpr float cosP1 = -1.388731625493765e-3f;
+    constexpr float cosP2 = 4.166664568298827e-2f;
+    constexpr float sqrtHalf = 0.707106781186547524f;
+    constexpr float logP[9] = {7.0376836292e-2f, -1.1514610310e-1f, 1.1676998740e-1f, -1.2420140846e-1f,
+                               1.4249322787e-1f, -1.6668057665e-1f, 2.0000714765e-1f, -2.4999993993e-1f,
+                               3.3333331174e-1f};
+    constexpr float logQ1 = -2.12194440e-4f;
+    constexpr float logQ2 = 0.693359375f;
+}
+
+GA_TARGET_AVX2 inline __m256 sin256(__m256 x)
+{
+    using namespace detail;
+    const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+    __m256 sign = _mm256_and_ps(x, signMask);
+    x = _mm256_andnot_ps(signMask, x);
+
+    // j = (int)(x*4/pi) rounded up to even, selects the octant
+    __m256i j = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(fourOverPi)));
+    j = _mm256_add_epi32(j, _mm256_set1_epi32(1));
+    j = _mm256_and_si256(j, _mm256_set1_epi32(~1));
+    __m256 y = _mm256_cvtepi32_ps(j);
+
+    __m256 flip = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(j, _mm256_set1_epi32(4)), 29));
+    __m256 useCos = _mm256_castsi256_ps(
+        _mm256_cmpeq_epi32(_mm256_and_si256(j, _mm256_set1_epi32(2)), _mm256_set1_epi32(2)));
+    sign = _mm256_xor_ps(sign, flip);
+
+    // extended precision modular arithmetic: x = x - y*pi/4
+    x = _mm256_fmadd_ps(y, _mm256_set1_ps(dp1), x);
+    x = _mm256_fmadd_ps(y, _mm256_set1_ps(dp2), x);
+    x = _mm256_fmadd_ps(y, _mm256_set1_ps(dp3), x);
+    __m256 z = _mm256_mul_ps(x, x);
+
+    __m256 c = _mm256_fmadd_ps(_mm256_set1_ps(cosP0), z, _mm256_set1_ps(cosP1));
+    c = _mm256_fmadd_ps(c, z, _mm256_set1_ps(cosP2));
+    c = _mm256_mul_ps(_mm256_mul_ps(c, z), z);
+    c = _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, c);
+    c = _mm256_add_ps(c, _mm256_set1_ps(1.0f));
+
+    __m256 s = _mm256_fmadd_ps(_mm256_set1_ps(sinP0), z, _mm256_set1_ps(sinP1));
+    s = _mm256_fmadd_ps(s, z, _mm256_set1_ps(sinP2));
+    s = _mm256_fmadd_ps(_mm256_mul_ps(s, z), x, x);
+
+    return _mm256_xor_ps(_mm256_blendv_ps(s, c, useCos), sign);
+}
+
+GA_TARGET_AVX512 inline __m512 sin512(__m512 x)
+{
+    using namespace detail;
+    const __m512i signMask = _mm512_set1_epi32(0x80000000);
+    __m512i sign = _mm512_and_si512(_mm512_castps_si512(x), signMask);
+    x = _mm512_castsi512_ps(_mm512_andnot_si512(signMask, _mm512_castps_si512(x)));
+
+    __m512i j = _mm512_cvttps_epi32(_mm512_mul_ps(x, _mm512_set1_ps(fourOverPi)));
+    j = _mm512_add_epi32(j, _mm512_set1_epi32(1));
+    j = _mm512_and_si512(j, _mm512_set1_epi32(~1));
+    __m512 y = _mm512_cvtepi32_ps(j);
+
+    __m512i flip = _mm512_slli_epi32(_mm512_and_si512(j, _mm512_set1_epi32(4)), 29);
+    __mmask16 useCos = _mm512_test_epi32_mask(j, _mm512_set1_epi32(2));
+    sign = _mm512_xor_si512(sign, flip);
+
+    x = _mm512_fmadd_ps(y, _mm512_set1_ps(dp1), x);
+    x = _mm512_fmadd_ps(y, _mm512_set1_ps(dp2), x);
+    x = _mm512_fmadd_ps(y, _mm512_set1_ps(dp3), x);
+    __m512 z = _mm512_mul_ps(x, x);
+
+    __m512 c = _mm512_fmadd_ps(_mm512_set1_ps(cosP0), z, _mm512_set1_ps(cosP1));
+    c = _mm512_fmadd_ps(c, z, _mm512_set1_ps(cosP2));
+    c = _mm512_mul_ps(_mm512_mul_ps(c, z), z);
+    c = _mm512_fnmadd_ps(_mm512_set1_ps(0.5f), z, c);
+    c = _mm512_add_ps(c, _mm512_set1_ps(1.0f));
+
+    __m512 s = _mm512_fmadd_ps(_mm512_set1_ps(sinP0), z, _mm512_set1_ps(sinP1));
+    s = _mm512_fmadd_ps(s, z, _mm512_set1_ps(sinP2));
+    s = _mm512_fmadd_ps(_mm512_mul_ps(s, z), x, x);
+
+    __m512 r = _mm512_mask_blend_ps(useCos, s, c);
+    return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(r), sign));
+}
+/* log(x) for 8/16 positive, normal floats (cephes logf: x = m*2^e with m in [sqrt(1/2), sqrt(2)),
+   then a degree 9 polynomial in m-1, max error ~1 ulp) */
+
+GA_TARGET_AVX2 inline __m256 log256(__m256 x)
+{
+    using namespace detail;
+    __m256i bits = _mm256_castps_si256(x);
+    __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+    __m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)),
+                                                   _mm256_set1_epi32(0x3f000000))); // in [0.5, 1)
+    __m256 small = _mm256_cmp_ps(m, _mm256_set1_ps(sqrtHalf), _CMP_LT_OQ);
+    e = _mm256_sub_ps(e, _mm256_and_ps(small, _mm256_set1_ps(1.0f)));
+    m = _mm256_sub_ps(_mm256_add_ps(m, _mm256_and_ps(small, m)), _mm256_set1_ps(1.0f));
+    __m256 z = _mm256_mul_ps(m, m);
+
+    __m256 y = _mm256_set1_ps(logP[0]);
+    for(int i=1; i<9; i++) y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(logP[i]));
+    y = _mm256_mul_ps(_mm256_mul_ps(y, m), z);
+    y = _mm256_fmadd_ps(e, _mm256_set1_ps(logQ1), y);
+    y = _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, y);
+    return _mm256_fmadd_ps(e, _mm256_set1_ps(logQ2), _mm256_add_ps(m, y));
+}
+
+GA_TARGET_AVX512 inline __m512 log512(__m512 x)
+{
+    using namespace detail;
+    __m512i bits = _mm512_castps_si512(x);
+    __m512 e = _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(bits, 23), _mm512_set1_epi32(126)));
+    __m512 m = _mm512_castsi512_ps(_mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi32(0x007fffff)),
+                                                   _mm512_set1_epi32(0x3f000000)));
+    __mmask16 small = _mm512_cmp_ps_mask(m, _mm512_set1_ps(sqrtHalf), _CMP_LT_OQ);
+    e = _mm512_mask_sub_ps(e, small, e, _mm512_set1_ps(1.0f));
+    m = _mm512_sub_ps(_mm512_mask_add_ps(m, small, m, m), _mm512_set1_ps(1.0f));
+    __m512 z = _mm512_mul_ps(m, m);
+
+    __m512 y = _mm512_set1_ps(logP[0]);
+    for(int i=1; i<9; i++) y = _mm512_fmadd_ps(y, m, _mm512_set1_ps(logP[i]));
+    y = _mm512_mul_ps(_mm512_mul_ps(y, m), z);
+    y = _mm512_fmadd_ps(e, _mm512_set1_ps(logQ1), y);
+    y = _mm512_fnmadd_ps(_mm512_set1_ps(0.5f), z, y);
+    return _mm512_fmadd_ps(e, _mm512_set1_ps(logQ2), _mm512_add_ps(m, y));
+}
+#endif // GA_SIMD_X86
+
+} // namespace simd
+
+#endif // INCLUDE_GA_SIMD
@@ -0,0 +1,324 @@
+#ifndef INCLUDE_GA_SNAPSHOT
+#define INCLUDE_GA_SNAPSHOT
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include <filesystem>
+#ifdef GA_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#include "migration.hpp"
+#include "config.hpp"
+#include "utils.hpp"
+
+/* Population snapshots ("print every"), written while the run goes on by a background thread.
+
+   Every island copies its share of the population into a slot of its own bounded single producer /
+   single consumer queue (see migration.hpp) and carries on: when the queue is full the snapshot is
+   dropped, so an island never waits on the disk. The writer thread assembles the shares of each
+   iteration into the whole population and writes it out once every island has delivered it (or has
+   stopped, or has moved past it having dropped it; those rows then hold the island's latest share).
+   At most maxPending snapshots are assembled at a time, an older one is written as it stands
+   ("incomplete") to make room, so memory stays bounded however far islands drift apart.
+
+   text    Results/iterN.txt, one solution per line: x1, x2, ..., xn, f
+   binary  Results/iterN.gasnap, little endian, read by Example/SchwefelFunction/snapshot.py
+
+           char[8]  "GASNAP\0\0"
+           uint32   version (1)
+           uint32   flags, bit 0: columns are compressed
+           int64    iteration
+           int32    rows
+           int32    dimension
+           then dimension+1 columns (x1 .. xn, f) of rows float32 each. A compressed column is a
+           uint32 byte count followed by a zlib stream of the column's bytes shuffled into 4 planes
+           (every first byte, then every second ...), which compresses floats far better */
+
+struct SnapshotStats
+{
+    long written = 0;    // snapshots written out
+    long incomplete = 0; // written with some island's rows not from that iteration
+    long dropped = 0;    // island shares not queued because the queue was full
+    long failed = 0;     // snapshots that could not be written
+};
+
+class SnapshotWriter
+{
+private:
+    struct Share
+    {   // one island's rows at one iteration, columns x1 .. xn, f of capacity floats each
+        long iteration = 0;
+        int rows = 0;
+        std::vector<float> columns;
+    };
+
+    struct alignas(64) Island
+    {
+        int rangeStart;
+        int rangeEnd;
+        std::unique_ptr<SpscQueue<Share>> queue;
+        std::atomic<bool> finished{false}; // no more shares will be queued
+        long dropped = 0;                   // written by the island only
+        // the writer thread's view
+        long latestIteration = -1;
+        bool drained = false;               // finished and everything it queued has been taken
+    };
+
+    struct Pending
+    {   // a snapshot being assembled, columns of _rows floats each
+        std::vector<float> columns;
+        std::vector<char> delivered; // per island
+    };
+
+    std::string _directory;
+    SnapshotFormat _format;
+    bool _compress;
+    int _dimension;
+    int _rows;
+    int _maxPending;
+    std::vector<std::unique_ptr<Island>> _islands;
+    std::vector<float> _latest;     // every island's latest share, columns of _rows floats
+    std::map<long, Pending> _pending;
+    long _lastWritten = -1;         // snapshots go out in order, a share older than this one arrived too late
+    SnapshotStats _stats;           // writer side (written, incomplete, failed)
+    std::atomic<bool> _stop{false};
+    std::mutex _sleepGuard;
+    std::condition_variable _wake;
+    std::thread _thread;
+    std::vector<unsigned char> _scratch;
+
+    bool ready(long iteration, const Pending& pending) const
+    {
+        for(int i=0; i<_islands.size(); i++)
+        {
+            const Island& island = *_islands[i];
+            if(!pending.delivered[i] && !island.drained && island.latestIteration <= iteration) return false;
+        }
+        return true;
+    }
+
+    void take(int index, const Share& share)
+    {   // a share has arrived, keep it as the island's latest and add it to its snapshot
+        Island& island = *_islands[index];
+        island.latestIteration = share.iteration;
+        const int capacity = island.rangeEnd - island.rangeStart;
+        for(int c=0; c<=_dimension; c++)
+        {
+            std::copy(share.columns.begin() + static_cast<size_t>(c) * capacity,
+                      share.columns.begin() + static_cast<size_t>(c) * capacity + share.rows,
+                      _latest.begin() + static_cast<size_t>(c) * _rows + island.rangeStart);
+        }
+        if(share.iteration <= _lastWritten) return;
+        auto it = _pending.find(share.iteration);
+        if(it == _pending.end())
+        {
+            if(_pending.size() >= _maxPending) emit(_pending.begin());
+            if(share.iteration <= _lastWritten) return;
+            it = _pending.emplace(share.iteration, Pending{_latest, std::vector<char>(_islands.size(), 0)}).first;
+        }else
+        {
+            for(int c=0; c<=_dimension; c++)
+            {
+                std::copy(_latest.begin() + static_cast<size_t>(c) * _rows + island.rangeStart,
+                          _latest.begin() + static_cast<size_t>(c) * _rows + island.rangeEnd,
+                          it->second.columns.begin() + static_cast<size_t>(c) * _rows + island.rangeStart);
+            }
+        }
+        it->second.delivered[index] = 1;
+    }
+
+    void emit(std::map<long, Pending>::iterator it)
+    {   // write out a snapshot, islands that did not deliver it contribute their latest rows
+        Pending& pending = it->second;
+        bool complete = true;
+        for(int i=0; i<_islands.size(); i++)
+        {
+            if(pending.delivered[i]) continue;
+            complete = false;
+            const Island& island = *_islands[i];
+            for(int c=0; c<=_dimension; c++)
+            {
+                std::copy(_latest.begin() + static_cast<size_t>(c) * _rows + island.rangeStart,
+                          _latest.begin() + static_cast<size_t>(c) * _rows + island.rangeEnd,
+                          pending.columns.begin() + static_cast<size_t>(c) * _rows + island.rangeStart);
+            }
+        }
+        bool ok = _format == SnapshotFormat::binary ? writeBinary(it->first, pending.columns)
+                                                    : writeText(it->first, pending.columns);
+        _stats.written += ok;
+        _stats.failed += !ok;
+        _stats.incomplete += ok && !complete;
+        _lastWritten = it->first;
+        _pending.erase(it);
+    }
+
+    std::string path(long iteration, const char* extension) const
+    {
+        std::stringstream ss;
+        ss << _directory << "/iter" << iteration << extension;
+        return ss.str();
+    }
+
+    bool writeText(long iteration, const std::vector<float>& columns)
+    {   // the format of operator<< for a soln
+        std::ofstream out(path(iteration, ".txt"), std::ios::out|std::ios::trunc);
+        for(int r=0; r<_rows; r++)
+        {
+            for(int d=0; d<_dimension; d++) out << columns[static_cast<size_t>(d) * _rows + r] << ", ";
+            out << columns[static_cast<size_t>(_dimension) * _rows + r] << '\n';
+        }
+        return out.good();
+    }
+
+    bool writeBinary(long iteration, const std::vector<float>& columns)
+    {
+        std::ofstream out(path(iteration, ".gasnap"), std::ios::out|std::ios::trunc|std::ios::binary);
+        const char magic[8] = {'G', 'A', 'S', 'N', 'A', 'P', 0, 0};
+        const uint32_t version = 1;
+        const uint32_t flags = _compress ? 1 : 0;
+        const int64_t iter = iteration;
+        const int32_t rows = _rows;
+        const int32_t dimension = _dimension;
+        out.write(magic, sizeof(magic));
+        out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        out.write(reinterpret_cast<const char*>(&flags), sizeof(flags));
+        out.write(reinterpret_cast<const char*>(&iter), sizeof(iter));
+        out.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+        out.write(reinterpret_cast<const char*>(&dimension), sizeof(dimension));
+        for(int c=0; c<=_dimension; c++)
+        {
+            const float* column = columns.data() + static_cast<size_t>(c) * _rows;
+            if(!_compress)
+            {
+                out.write(reinterpret_cast<const char*>(column), sizeof(float) * _rows);
+                continue;
+            }
+#ifdef GA_HAVE_ZLIB
+            const size_t bytes = sizeof(float) * _rows;
+            std::vector<unsigned char> shuffled(bytes);
+            const unsigned char* raw = reinterpret_cast<const unsigned char*>(column);
+            for(int r=0; r<_rows; r++)
+            {
+                for(int b=0; b<4; b++) shuffled[b * static_cast<size_t>(_rows) + r] = raw[4*r + b];
+            }
+            uLongf compressedBytes = compressBound(bytes);
+            _scratch.resize(compressedBytes);
+            if(compress2(_scratch.data(), &compressedBytes, shuffled.data(), bytes, Z_DEFAULT_COMPRESSION) != Z_OK) return false;
+            const uint32_t length = compressedBytes;
+            out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            out.write(reinterpret_cast<const char*>(_scratch.data()), length);
+#endif
+        }
+        return out.good();
+    }
+
+    void run()
+    {   // the writer thread: take whatever the islands queued, write the snapshots that are complete
+        Share share;
+        while(true)
+        {
+            const bool stopping = _stop.load(std::memory_order_acquire);
+            bool took = false;
+            for(int i=0; i<_islands.size(); i++)
+            {
+                Island& island = *_islands[i];
+                const bool finished = island.finished.load(std::memory_order_acquire); // before the pop, so
+                while(island.queue->tryPop(share))                                     // nothing is missed
+                {
+                    take(i, share);
+                    took = true;
+                }
+                if(finished) island.drained = true;
+            }
+            while(!_pending.empty() && ready(_pending.begin()->first, _pending.begin()->second)) emit(_pending.begin());
+            if(stopping)
+            {   // every island has finished, whatever is left goes out as it stands
+                while(!_pending.empty()) emit(_pending.begin());
+                return;
+            }
+            if(!took)
+            {
+                std::unique_lock<std::mutex> lock(_sleepGuard);
+                _wake.wait_for(lock, std::chrono::milliseconds(5));
+            }
+        }
+    }
+
+public:
+    // islands[i] = (rangeStart, rangeEnd) of island i in a population of rows solutions of dimension
+    // coordinates, each island can have up to queueCapacity shares waiting
+    SnapshotWriter(const std::string& directory, SnapshotFormat format, bool compress, int dimension, int rows,
+                   const std::vector<std::pair<int, int>>& islands, int queueCapacity = 4, int maxPending = 4)
+        : _directory(directory), _format(format), _compress(compress), _dimension(dimension), _rows(rows),
+          _maxPending(maxPending), _latest(static_cast<size_t>(dimension + 1) * rows, 0.0f)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(_directory, error);
+        for(const auto& range : islands)
+        {
+            auto island = std::make_unique<Island>();
+            island->rangeStart = range.first;
+            island->rangeEnd = range.second;
+            Share prototype; // slots are sized up front, queueing a share does not allocate
+            prototype.columns.assign(static_cast<size_t>(dimension + 1) * (range.second - range.first), 0.0f);
+            island->queue = std::make_unique<SpscQueue<Share>>(queueCapacity, prototype);
+            _islands.push_back(std::move(island));
+        }
+        _thread = std::thread(&SnapshotWriter::run, this);
+    }
+
+    ~SnapshotWriter() { close(); }
+
+    template <typename Population>
+    void submit(int island, long iteration, const Population& population)
+    {   // queue island's population at iteration, or drop it if the queue is full (never blocks)
+        Island& self = *_islands[island];
+        const int capacity = self.rangeEnd - self.rangeStart;
+        bool queued = self.queue->tryPushWith([&](Share& share)
+        {
+            share.iteration = iteration;
+            share.rows = std::min<int>(population.size(), capacity);
+            for(int r=0; r<share.rows; r++)
+            {
+                for(int d=0; d<_dimension; d++) share.columns[static_cast<size_t>(d) * capacity + r] = population[r].getX(d);
+                share.columns[static_cast<size_t>(_dimension) * capacity + r] = population[r].getEval();
+            }
+        });
+        if(queued) _wake.notify_one();
+        else self.dropped += 1;
+    }
+
+    void finish(int island)
+    {   // the island queues nothing more
+        _islands[island]->finished.store(true, std::memory_order_release);
+        _wake.notify_one();
+    }
+
+    void close()
+    {   // write out everything still queued or pending and stop the thread, once every island finished
+        if(!_thread.joinable()) return;
+        _stop.store(true, std::memory_order_release);
+        _wake.notify_one();
+        _thread.join();
+    }
+
+    SnapshotStats stats() const
+    {   // complete once closed
+        SnapshotStats stats = _stats;
+        for(const auto& island : _islands) stats.dropped += island->dropped;
+        return stats;
+    }
+};
+
+#endif // INCLUDE_GA_SNAPSHOT
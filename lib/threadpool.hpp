@@ -0,0 +1,203 @@
+#ifndef INCLUDE_GA_THREADPOOL
+#define INCLUDE_GA_THREADPOOL
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+
+/* A persistent pool of worker threads with work stealing. Every worker owns a deque of tasks: it
+   runs its own in submission order (islands requeue themselves after every migration, so islands
+   sharing a worker take turns) and, once that is empty, steals the newest task of another worker, so
+   a worker whose island finished early keeps busy with the others'. Tasks submitted from outside
+   the pool are dealt round robin, idle workers sleep until something is submitted.
+
+   ThreadPool::shared() is the process-wide pool the GA runs on, so repeated optimise() calls reuse
+   the same threads instead of spawning new ones. Shared pools live until the process exits, one per
+   size asked for. */
+
+class TaskCounter
+{   // outstanding tasks, wait() returns once every one added has called done()
+private:
+    std::mutex _guard;
+    std::condition_variable _finished;
+    int _pending = 0;
+
+public:
+    void add(int n = 1)
+    {
+        std::lock_guard<std::mutex> lock(_guard);
+        _pending += n;
+    }
+
+    void done()
+    {
+        std::lock_guard<std::mutex> lock(_guard);
+        _pending -= 1;
+        if(_pending == 0) _finished.notify_all();
+    }
+
+    bool finished()
+    {
+        std::lock_guard<std::mutex> lock(_guard);
+        return _pending == 0;
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(_guard);
+        _finished.wait(lock, [&]{ return _pending == 0; });
+    }
+};
+
+class ThreadPool
+{
+private:
+    struct Worker
+    {
+        std::mutex guard;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::vector<std::thread> _threads;
+    std::mutex _sleepGuard;
+    std::condition_variable _wake;
+    std::atomic<int> _queued{0};
+    std::atomic<unsigned> _nextWorker{0};
+    bool _stop = false;
+
+    // the pool and worker index of the calling thread, if it is a worker
+    static inline thread_local ThreadPool* _currentPool = nullptr;
+    static inline thread_local int _currentWorker = -1;
+
+    bool tryRun(int self)
+    {   // run one task: the oldest of our own, or else the newest of another worker's
+        std::function<void()> task;
+        const int n = _workers.size();
+        for(int k=0; k<n && !task; k++)
+        {
+            Worker& w = *_workers[(self + k) % n];
+            std::lock_guard<std::mutex> lock(w.guard);
+            if(w.tasks.empty()) continue;
+            if(k == 0)
+            {
+                task = std::move(w.tasks.front());
+                w.tasks.pop_front();
+            }else
+            {
+                task = std::move(w.tasks.back());
+                w.tasks.pop_back();
+            }
+        }
+        if(!task) return false;
+        _queued.fetch_sub(1);
+        task();
+        return true;
+    }
+
+    void workerLoop(int self)
+    {
+        _currentPool = this;
+        _currentWorker = self;
+        while(true)
+        {
+            if(tryRun(self)) continue;
+            std::unique_lock<std::mutex> lock(_sleepGuard);
+            _wake.wait(lock, [&]{ return _stop || _queued.load() > 0; });
+            if(_stop && _queued.load() == 0) return;
+        }
+    }
+
+public:
+    explicit ThreadPool(int threads = 0)
+    {   // threads = 0 uses one worker per hardware thread
+        if(threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for(int i=0; i<threads; i++) _workers.push_back(std::make_unique<Worker>());
+        for(int i=0; i<threads; i++) _threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+
+    ~ThreadPool()
+    {   // finishes the queued tasks, then joins the workers
+        {
+            std::lock_guard<std::mutex> lock(_sleepGuard);
+            _stop = true;
+        }
+        _wake.notify_all();
+        for(std::thread& t : _threads) t.join();
+    }
+
+    int size() const { return _threads.size(); }
+
+    void submit(std::function<void()> task)
+    {   // a worker keeps what it submits on its own deque, anyone else deals round robin
+        int target = _currentPool == this ? _currentWorker : _nextWorker.fetch_add(1) % _workers.size();
+        _queued.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(_workers[target]->guard);
+            _workers[target]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(_sleepGuard); // a worker about to sleep sees _queued
+        }
+        _wake.notify_one();
+    }
+
+    void wait(TaskCounter& counter)
+    {   // block until counter finishes, a worker thread runs other tasks meanwhile instead
+        if(_currentPool != this) return counter.wait();
+        while(!counter.finished())
+        {
+            if(!tryRun(_currentWorker)) std::this_thread::yield();
+        }
+    }
+
+    template <typename F>
+    void parallelFor(int begin, int end, int grain, F&& f)
+    {   // f(chunkBegin, chunkEnd) over [begin, end) in chunks of grain, the caller takes chunks too, so
+        // this never waits on a worker that is busy elsewhere. The chunks are the same however many
+        // workers there are, so f sees the same ranges on every machine
+        const int chunks = (end - begin + grain - 1) / grain;
+        if(chunks <= 1 || size() <= 1)
+        {
+            for(int c=0; c<chunks; c++) f(begin + c * grain, std::min(end, begin + (c+1) * grain));
+            return;
+        }
+        struct State
+        {
+            std::atomic<int> next{0};
+            std::atomic<int> finished{0};
+        };
+        auto state = std::make_shared<State>(); // helpers that start after the last chunk only touch this
+        auto work = [state, begin, end, grain, chunks, &f]()
+        {
+            for(int c=state->next.fetch_add(1); c<chunks; c=state->next.fetch_add(1))
+            {
+                f(begin + c * grain, std::min(end, begin + (c+1) * grain));
+                state->finished.fetch_add(1, std::memory_order_release);
+            }
+        };
+        for(int i=0; i<std::min(chunks - 1, size()); i++) submit(work);
+        work();
+        while(state->finished.load(std::memory_order_acquire) < chunks) std::this_thread::yield();
+    }
+
+    static ThreadPool& shared(int threads = 0)
+    {   // the process-wide pool of threads workers (0: the first pool started, else one worker per
+        // hardware thread), started on first use. GAs and batches keep using the pool they were given,
+        // so no pool is ever destroyed: asking for another size starts another pool next to it
+        static std::mutex guard;
+        static std::vector<std::unique_ptr<ThreadPool>> pools;
+        std::lock_guard<std::mutex> lock(guard);
+        for(auto& pool : pools) if(threads <= 0 || pool->size() == threads) return *pool;
+        pools.push_back(std::make_unique<ThreadPool>(threads));
+        return *pools.back();
+    }
+};
+
+#endif // INCLUDE_GA_THREADPOOL
@@ -6,6 +6,7 @@
 #include <mutex>
 #include <chrono>
 #include <random>
+#include "profile.hpp"
 
 std::timed_mutex coutGuard; // use for thread-safe cout
 const std::chrono::duration<double, std::milli> default_timeout(10); // default timeout for waiting for cout lock
@@ -17,19 +18,29 @@ const std::chrono::duration<double, std::milli> default_timeout(10); // default
 
 #define LOG(...) std::cout << __VA_ARGS__ ; 
 
+bool lockCout()
+{   // wait up to default_timeout for cout, false if it timed out (the caller prints anyway, unlocked)
+    profile::Wait wait;
+    return coutGuard.try_lock_for(default_timeout);
+}
+
 // thread-safe printing to iostream for multiple arguments: THREADPRINT(a << b << c)
+// (a block, so it is one statement after an if, and it only unlocks what it locked)
 #define THREADPRINT(...) \
-    coutGuard.try_lock_for(default_timeout); \
-    std::cout << __VA_ARGS__; \
-    coutGuard.unlock();
+    { \
+        const bool CONCAT(coutLocked, __LINE__) = lockCout(); \
+        std::cout << __VA_ARGS__; \
+        if(CONCAT(coutLocked, __LINE__)) coutGuard.unlock(); \
+    }
 
-// thread-blocking reserve of iostream
-#define RESERVECOUT coutGuard.try_lock_for(default_timeout);
+// thread-blocking reserve of iostream, UNRESERVECOUT must follow in the same scope
+#define RESERVECOUT const bool coutReserved = lockCout();
 
-#define UNRESERVECOUT coutGuard.unlock();
+#define UNRESERVECOUT if(coutReserved) coutGuard.unlock();
 
 // get a random integer within given bounds
-int intRand(const int & min, const int & max, std::mt19937& generator) {
+template <typename Gen>
+int intRand(const int & min, const int & max, Gen& generator) {
     std::uniform_int_distribution<int> distribution(min,max);
     return distribution(generator);
 }
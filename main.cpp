@@ -3,37 +3,280 @@
 #include <string>
 #include <unordered_map>
 #include <chrono>
+#include <climits>
+#include <spawn.h>
+#include <sys/wait.h>
 #include "lib/core.hpp"
+#include "lib/batch.hpp"
 #include "third_party/nlohmann/json.hpp"
 #include "Example/SchwefelFunction/problem.hpp"
 
-int main(int argc, 
-         char *argv[]) {
-    if(argc<=1)
+void writeProfile(const GAConfig& gaConfig)
+{   // the timings of a GA_PROFILE build, see lib/profile.hpp
+    if(!profile::enabled) return;
+    if(profile::write(gaConfig.profileReport, gaConfig.profileTrace))
+        std::cout << "profile written to " << gaConfig.profileReport << " and " << gaConfig.profileTrace << '\n';
+    else std::cout << "cannot write the profile\n";
+}
+
+template <typename T, typename Population>
+void run(const GAConfig& gaConfig, const Schwefel::Config& config, const char* resumeFrom)
+{   // run the GA on the Schwefel problem for one dimension and population layout, or continue a checkpointed run
+    GA<Schwefel::Problem<T, Population>> GAinst(Schwefel::Problem<T, Population>(config), gaConfig);
+    profile::reset(!gaConfig.profileTrace.empty());
+    if(resumeFrom) GAinst.resume(resumeFrom);
+    else
     {
-        std::cout << "missing paramters.json file\n";
-    }else if(argc==2)
+        GAinst.generateInitialPopulation();
+        if(gaConfig.printResults) GAinst.printToFile("populationInitial.txt");
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    GAinst.optimise();
+    auto finish = std::chrono::high_resolution_clock::now();
+    std::cout << "Optimisation took " << 
+            std::chrono::duration_cast<std::chrono::milliseconds>(finish-start).count() << "ms\n";
+    if(gaConfig.printResults) GAinst.printToFile("populationEnd.txt");
+    if(gaConfig.printResults) std::cout << "results printed to " << (resumeFrom ? "" : "populationInitial.txt and ") 
+                                        << "populationEnd.txt\n";
+    std::cout << "number of function evaluations: " << GAinst.evaluations() << " of a budget of " << gaConfig.maxEvaluations << '\n';
+    std::cout << "best solution: " << Schwefel::getBestSoln(*(GAinst.getPopulation())).print() << '\n';
+    writeProfile(gaConfig);
+}
+
+template <typename T, typename Population>
+BatchResult runOnce(const GAConfig& gaConfig, const Schwefel::Config& config)
+{   // one run of a batch, its islands take turns on the calling worker
+    GA<Schwefel::Problem<T, Population>> GAinst(Schwefel::Problem<T, Population>(config), gaConfig);
+    GAinst.runIslandsInline();
+    auto start = std::chrono::high_resolution_clock::now();
+    GAinst.generateInitialPopulation();
+    GAinst.optimise();
+    auto finish = std::chrono::high_resolution_clock::now();
+    BatchResult result;
+    result.bestFitness = Schwefel::getBestSoln(*(GAinst.getPopulation())).getEval();
+    result.evaluations = GAinst.evaluations();
+    result.wallMs = std::chrono::duration<double, std::milli>(finish-start).count();
+    return result;
+}
+
+bool readParameters(const char* path, GAConfig& gaConfig, Schwefel::Config& config)
+{   // parse and validate every parameter once, before anything runs
+    try
     {
-        std::ifstream f(argv[1]);
+        std::ifstream f(path);
+        if(!f) throw ConfigError(std::string("cannot open ") + path);
         nlohmann::json data = nlohmann::json::parse(f);
-        auto jmap = data.get<std::unordered_map<std::string, float>>();
+        ConfigReader reader(data);
+        gaConfig = GAConfig::read(reader);
+        config = Schwefel::Config::read(reader);
+        reader.finish();
+        return true;
+    }catch(const std::exception& e)
+    {
+        std::cout << "invalid parameters: " << e.what() << '\n';
+        return false;
+    }
+}
 
-        GA<Schwefel::soln> GAinst(Schwefel::problemCtx, jmap);
-        GAinst.generateInitialPopulation();
-        if(jmap["print results"]) GAinst.printToFile("populationInitial.txt");
+template <typename T, typename Population>
+void runWorker(GAConfig gaConfig, const Schwefel::Config& config, ClusterWorker& worker)
+{   // one worker of a cluster, from the seed the coordinator derived for it
+    gaConfig.seed = cluster::workerSeed(worker.seed(), worker.rank());
+    if(gaConfig.printEvery <= gaConfig.maxIterations)
+    {   // the workers would overwrite each other's Results/
+        std::cout << "--worker " << worker.rank() << ": no snapshots (\"print every\") in a cluster\n";
+        gaConfig.printEvery = INT_MAX;
+    }
+    GA<Schwefel::Problem<T, Population>> GAinst(Schwefel::Problem<T, Population>(config), gaConfig);
+    GAinst.joinCluster(&worker);
+    GAinst.generateInitialPopulation();
+    GAinst.optimise();
+    const std::string results = "populationEnd." + std::to_string(worker.rank()) + ".txt";
+    if(gaConfig.printResults) GAinst.printToFile(results);
+    T best = Schwefel::getBestSoln(*(GAinst.getPopulation()));
+    ClusterStats stats = worker.stats();
+    worker.finish(GAinst.evaluations(), best);
+    std::cout << "--worker " << worker.rank() << ": " << GAinst.evaluations() << " evaluations, " << stats.sent 
+              << " migrants sent to and " << stats.received << " received from other processes (" << stats.dropped 
+              << " dropped), best solution: " << best.print() << (gaConfig.printResults ? ", results printed to " + results : "") 
+              << '\n';
+}
+
+int clusterRun(const std::string& role, const char* parametersPath, const char* self)
+{   // GA_run --coordinator | --worker | --cluster parameters.json, see lib/cluster.hpp
+    GAConfig gaConfig;
+    Schwefel::Config config;
+    if(!readParameters(parametersPath, gaConfig, config)) return 1;
+    try
+    {
+        require(!gaConfig.reproducible, "a cluster needs \"reproducible\": false, migrants arrive whenever they do");
+        require(gaConfig.maxEvaluations >= static_cast<long>(gaConfig.processes) * gaConfig.populationSize,
+                "\"max_eval\" must at least cover the initial population of every one of the \"processes\"");
+    }catch(const ConfigError& e)
+    {
+        std::cout << "invalid parameters: " << e.what() << '\n';
+        return 1;
+    }
+    try
+    {
+        if(role == "--worker")
+        {
+            ClusterWorker worker(gaConfig.coordinatorSocket, config.dimension, 4 * gaConfig.numberOfThreads * gaConfig.migrants);
+            dispatchDimension<SCHWEFEL_DIMENSIONS>(config.dimension, [&](auto D){
+                typedef Schwefel::soln<decltype(D)::value> soln;
+                if(gaConfig.structureOfArrays) runWorker<soln, SoAPopulation<soln>>(gaConfig, config, worker);
+                else runWorker<soln, std::vector<soln>>(gaConfig, config, worker);
+            });
+            return 0;
+        }
+        ClusterCoordinator coordinator(gaConfig, config.dimension);
+        std::vector<pid_t> workers;
+        if(role == "--cluster")
+        {   // the workers are this program again (/proc/self/exe, whatever path it was started by), started
+            // once the coordinator listens
+            char* arguments[] = {const_cast<char*>(self), const_cast<char*>("--worker"), const_cast<char*>(parametersPath), nullptr};
+            for(int i=0; i<gaConfig.processes; i++)
+            {
+                pid_t pid;
+                if(posix_spawn(&pid, "/proc/self/exe", nullptr, nullptr, arguments, environ) != 0)
+                    throw ClusterError(std::string("cannot start a worker ") + self);
+                workers.push_back(pid);
+            }
+        }
         auto start = std::chrono::high_resolution_clock::now();
-        GAinst.optimise();
+        coordinator.run();
         auto finish = std::chrono::high_resolution_clock::now();
+        for(pid_t pid : workers) waitpid(pid, nullptr, 0);
         std::cout << "Optimisation took " << 
                 std::chrono::duration_cast<std::chrono::milliseconds>(finish-start).count() << "ms\n";
-        if(jmap["print results"]) GAinst.printToFile("populationEnd.txt");
-        if(jmap["print results"]) std::cout << "results printed to populationInitial.txt and populationEnd.txt\n";
-        std::cout << "number of function evaluations: " << Schwefel::num_of_evaluations << '\n';
-        std::cout << "best solution: " << Schwefel::getBestSoln(*(GAinst.getPopulation())).print() << '\n';
+        std::cout << "number of function evaluations: " << coordinator.evaluations() << " of a budget of " 
+                  << gaConfig.maxEvaluations << '\n';
+        const std::vector<float>& best = coordinator.best();
+        if(best.empty()) std::cout << "no worker reported a solution\n";
+        else
+        {
+            Schwefel::soln<0> s(config.dimension);
+            cluster::unpack(best.data(), config.dimension, s);
+            std::cout << "best solution: " << s.print() << '\n';
+        }
+    }catch(const ClusterError& e)
+    {
+        std::cout << "cluster failed: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
+
+int batch(const char* specPath)
+{   // GA_run --batch sweep.json, see lib/batch.hpp
+    BatchSpec spec;
+    std::vector<BatchRun> runs;
+    std::vector<std::pair<GAConfig, Schwefel::Config>> configs;
+    try
+    {   // every run's parameters are validated before the first one starts
+        std::ifstream f(specPath);
+        if(!f) throw ConfigError(std::string("cannot open ") + specPath);
+        nlohmann::json data = nlohmann::json::parse(f);
+        ConfigReader reader(data);
+        spec = BatchSpec::read(reader, std::filesystem::path(specPath).parent_path().string());
+        reader.finish();
+        runs = spec.runs();
+        for(const BatchRun& run : runs)
+        {
+            try
+            {
+                ConfigReader runReader(run.parameters);
+                GAConfig gaConfig = GAConfig::read(runReader);
+                Schwefel::Config config = Schwefel::Config::read(runReader);
+                runReader.finish();
+                configs.push_back({gaConfig, config});
+            }catch(const std::exception& e)
+            {
+                throw ConfigError("grid point " + std::to_string(run.point) + ": " + e.what());
+            }
+        }
+    }catch(const std::exception& e)
+    {
+        std::cout << "invalid batch: " << e.what() << '\n';
+        return 1;
+    }
+
+    ThreadPool& pool = ThreadPool::shared(spec.workerThreads);
+    std::cout << "--batch: " << runs.size() << " runs (" << spec.points() << " grid points x " << spec.seeds.size() 
+              << " seeds x " << spec.repeats << " repeats) on " << pool.size() << " worker threads\n";
+    profile::reset(!configs.front().first.profileTrace.empty());
+    auto start = std::chrono::high_resolution_clock::now();
+    auto runOne = [&](const BatchRun& run)
+    {
+        const GAConfig& gaConfig = configs[run.run].first;
+        const Schwefel::Config& config = configs[run.run].second;
+        BatchResult result;
+        dispatchDimension<SCHWEFEL_DIMENSIONS>(config.dimension, [&](auto D){
+            typedef Schwefel::soln<decltype(D)::value> soln;
+            if(gaConfig.structureOfArrays) result = runOnce<soln, SoAPopulation<soln>>(gaConfig, config);
+            else result = runOnce<soln, std::vector<soln>>(gaConfig, config);
+        });
+        return result;
+    };
+    try
+    {
+        std::vector<BatchResult> results = runBatch(runs, pool, spec.concurrentRuns, runOne);
+        writeBatchTable(spec.output, spec.format, spec, runs, results);
+    }catch(const std::exception& e)
+    {
+        std::cout << "batch failed: " << e.what() << '\n';
+        return 1;
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    std::cout << "Batch took " << std::chrono::duration_cast<std::chrono::milliseconds>(finish-start).count() 
+              << "ms, results written to " << spec.output << '\n';
+    writeProfile(configs.front().first); // every run together
+    return 0;
+}
+
+int main(int argc, 
+         char *argv[]) {
+    if(argc<=1)
+    {
+        std::cout << "missing paramters.json file\n";
+        std::cout << "usage: GA_run parameters.json [checkpoint to resume]\n"
+                  << "       GA_run --batch sweep.json\n"
+                  << "       GA_run --cluster | --coordinator | --worker parameters.json\n";
+    }else if(argc==3 && std::string(argv[1]) == "--batch")
+    {
+        return batch(argv[2]);
+    }else if(argc==3 && (std::string(argv[1]) == "--cluster" || std::string(argv[1]) == "--coordinator" 
+                         || std::string(argv[1]) == "--worker"))
+    {
+        return clusterRun(argv[1], argv[2], argv[0]);
+    }else if(argc<=3)
+    {
+        GAConfig gaConfig;
+        Schwefel::Config config;
+        if(!readParameters(argv[1], gaConfig, config)) return 1;
+
+        // fixed-size soln for the pre-instantiated dimensions, runtime-sized soln<0> otherwise
+        const char* resumeFrom = argc==3 ? argv[2] : nullptr;
+        try
+        {
+            dispatchDimension<SCHWEFEL_DIMENSIONS>(config.dimension, [&](auto D){
+                typedef Schwefel::soln<decltype(D)::value> soln;
+                if(gaConfig.structureOfArrays) run<soln, SoAPopulation<soln>>(gaConfig, config, resumeFrom);
+                else run<soln, std::vector<soln>>(gaConfig, config, resumeFrom); // array of structs, kept as the reference layout
+            });
+        }catch(const CheckpointError& e)
+        {
+            std::cout << "checkpoint failed: " << e.what() << '\n';
+            return 1;
+        }catch(const EvaluatorError& e)
+        {
+            std::cout << "evaluation failed: " << e.what() << '\n';
+            return 1;
+        }
     }else
     {
         std::cout << "too many arguments\n";
     }
 
     return 0;
-}
\ No newline at end of file
+}